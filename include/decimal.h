@@ -30,21 +30,44 @@
 #define DECIMAL_H
 
 #include <algorithm>
+#include <array>
+#include <cassert>
+#include <compare>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
 #include <random>
+#include <span>
 #include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include <bid_conf.h> // Intel's definitions
 
+// vector kernels for x86-64, chosen at run time
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define DECIMAL754_X86_SIMD
+#include <immintrin.h>
+#endif
+
 namespace decimal754 {
 
+// holds 32-bit decimals
+typedef uint32_t D32;
+
 // holds 64-bit decimals
 typedef uint64_t D64; 
 
 // holds 128-bit decimals
 typedef struct __attribute__((aligned(16))) D128 { 
 	uint64_t w[2];
-	friend inline bool operator!=(const D128 & l, const D128 & r) { return !(l == r); }
-	friend inline bool operator==(const D128 & l, const D128 & r) { return (l.w[0] == r.w[0]) && (l.w[1] == r.w[1]); }
+	friend inline constexpr bool operator!=(const D128 & l, const D128 & r) { return !(l == r); }
+	friend inline constexpr bool operator==(const D128 & l, const D128 & r) { return (l.w[0] == r.w[0]) && (l.w[1] == r.w[1]); }
 } D128; 
 
 typedef unsigned int RoundMode;
@@ -60,12 +83,15 @@ extern D128 __bid128_from_uint64 (uint64_t);
 extern D128 __bid128_from_int32 (int32_t);
 extern D128 __bid128_from_int64 (int64_t);
 extern D128 __bid128_round_integral_zero (D128 x, ErrorFlags *pfpsf);
+extern D128 __bid128_round_integral_exact (D128 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D128 __bid128_quantize (D128 x, D128 y, RoundMode rnd_mode, ErrorFlags *pfpsf);
 extern D128 __bid128_abs (D128 x);
 extern D128 __bid128_negate (D128 x);
 extern D128 __bid128_add ( D128, D128, RoundMode, ErrorFlags *);
 extern D128 __bid128_sub ( D128, D128, RoundMode, ErrorFlags *);
 extern D128 __bid128_mul ( D128, D128, RoundMode, ErrorFlags *);
 extern D128 __bid128_div ( D128, D128, RoundMode, ErrorFlags *);
+extern D128 __bid128_fma ( D128, D128, D128, RoundMode, ErrorFlags *);
 extern void __bid128_to_string ( char *ps, D128 x, ErrorFlags *pfpsf);
 extern uint8_t __bid128_to_uint8_xrnint (D128 x, ErrorFlags *pfpsf);
 extern uint16_t __bid128_to_uint16_xrnint (D128 x, ErrorFlags *pfpsf);
@@ -82,648 +108,3469 @@ extern D128 __binary64_to_bid128 (double x, _IDEC_round rnd_mode, _IDEC_flags *p
 extern int __bid128_isSigned (D128 x);
 extern int __bid128_isNormal (D128 x);
 extern int __bid128_isZero (D128 x);
+extern int __bid128_isSubnormal (D128 x);
+extern int __bid128_isFinite (D128 x);
+extern int __bid128_isInf (D128 x);
+extern int __bid128_isNaN (D128 x);
+extern int __bid128_isSignaling (D128 x);
+extern int __bid128_isCanonical (D128 x);
+extern int __bid128_class (D128 x);
+extern int __bid128_totalOrder (D128 x, D128 y);
 extern int __bid128_quiet_equal (D128 x, D128 y, ErrorFlags *pfpsf);
 extern int __bid128_quiet_less (D128 x, D128 y, ErrorFlags *pfpsf);
+extern D64 __bid128_to_bid64 (D128 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __bid128_to_bid32 (D128 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
 
-/* 64-bit functions */ // TODO: Implement 64-bit C functions
+/* 64-bit functions */
+extern D64 __bid64_from_string (char *ps, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D64 __bid64_from_uint32 (uint32_t);
+extern D64 __bid64_from_uint64 (uint64_t, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D64 __bid64_from_int32 (int32_t);
+extern D64 __bid64_from_int64 (int64_t, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D64 __bid64_round_integral_zero (D64 x, ErrorFlags *pfpsf);
+extern D64 __bid64_round_integral_exact (D64 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D64 __bid64_quantize (D64 x, D64 y, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D64 __bid64_abs (D64 x);
+extern D64 __bid64_negate (D64 x);
+extern D64 __bid64_add ( D64, D64, RoundMode, ErrorFlags *);
+extern D64 __bid64_sub ( D64, D64, RoundMode, ErrorFlags *);
+extern D64 __bid64_mul ( D64, D64, RoundMode, ErrorFlags *);
+extern D64 __bid64_div ( D64, D64, RoundMode, ErrorFlags *);
+extern D64 __bid64_fma ( D64, D64, D64, RoundMode, ErrorFlags *);
+extern void __bid64_to_string ( char *ps, D64 x, ErrorFlags *pfpsf);
+extern uint8_t __bid64_to_uint8_xrnint (D64 x, ErrorFlags *pfpsf);
+extern uint16_t __bid64_to_uint16_xrnint (D64 x, ErrorFlags *pfpsf);
+extern uint32_t __bid64_to_uint32_xrnint (D64 x, ErrorFlags *pfpsf);
+extern uint64_t __bid64_to_uint64_xrnint (D64 x, ErrorFlags *pfpsf);
+extern int8_t __bid64_to_int8_xrnint (D64 x, ErrorFlags *pfpsf);
+extern int16_t __bid64_to_int16_xrnint (D64 x, ErrorFlags *pfpsf);
+extern int32_t __bid64_to_int32_xrnint (D64 x, ErrorFlags *pfpsf);
+extern int64_t __bid64_to_int64_xrnint (D64 x, ErrorFlags *pfpsf);
+extern float __bid64_to_binary32 (D64 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern double __bid64_to_binary64 (D64 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D64 __binary32_to_bid64 (float x, _IDEC_round rnd_mode, _IDEC_flags *pfpsf);
+extern D64 __binary64_to_bid64 (double x, _IDEC_round rnd_mode, _IDEC_flags *pfpsf);
+extern int __bid64_isSigned (D64 x);
+extern int __bid64_isNormal (D64 x);
+extern int __bid64_isZero (D64 x);
+extern int __bid64_isSubnormal (D64 x);
+extern int __bid64_isFinite (D64 x);
+extern int __bid64_isInf (D64 x);
+extern int __bid64_isNaN (D64 x);
+extern int __bid64_isSignaling (D64 x);
+extern int __bid64_isCanonical (D64 x);
+extern int __bid64_class (D64 x);
+extern int __bid64_totalOrder (D64 x, D64 y);
+extern int __bid64_quiet_equal (D64 x, D64 y, ErrorFlags *pfpsf);
+extern int __bid64_quiet_less (D64 x, D64 y, ErrorFlags *pfpsf);
+extern D128 __bid64_to_bid128 (D64 x, ErrorFlags *pfpsf);
+extern D32 __bid64_to_bid32 (D64 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+
+/* 32-bit functions */
+extern D32 __bid32_from_string (char *ps, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __bid32_from_uint32 (uint32_t, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __bid32_from_uint64 (uint64_t, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __bid32_from_int32 (int32_t, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __bid32_from_int64 (int64_t, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __bid32_round_integral_zero (D32 x, ErrorFlags *pfpsf);
+extern D32 __bid32_quantize (D32 x, D32 y, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __bid32_abs (D32 x);
+extern D32 __bid32_negate (D32 x);
+extern D32 __bid32_add ( D32, D32, RoundMode, ErrorFlags *);
+extern D32 __bid32_sub ( D32, D32, RoundMode, ErrorFlags *);
+extern D32 __bid32_mul ( D32, D32, RoundMode, ErrorFlags *);
+extern D32 __bid32_div ( D32, D32, RoundMode, ErrorFlags *);
+extern D32 __bid32_fma ( D32, D32, D32, RoundMode, ErrorFlags *);
+extern void __bid32_to_string ( char *ps, D32 x, ErrorFlags *pfpsf);
+extern uint8_t __bid32_to_uint8_xrnint (D32 x, ErrorFlags *pfpsf);
+extern uint16_t __bid32_to_uint16_xrnint (D32 x, ErrorFlags *pfpsf);
+extern uint32_t __bid32_to_uint32_xrnint (D32 x, ErrorFlags *pfpsf);
+extern uint64_t __bid32_to_uint64_xrnint (D32 x, ErrorFlags *pfpsf);
+extern int8_t __bid32_to_int8_xrnint (D32 x, ErrorFlags *pfpsf);
+extern int16_t __bid32_to_int16_xrnint (D32 x, ErrorFlags *pfpsf);
+extern int32_t __bid32_to_int32_xrnint (D32 x, ErrorFlags *pfpsf);
+extern int64_t __bid32_to_int64_xrnint (D32 x, ErrorFlags *pfpsf);
+extern float __bid32_to_binary32 (D32 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern double __bid32_to_binary64 (D32 x, RoundMode rnd_mode, ErrorFlags *pfpsf);
+extern D32 __binary32_to_bid32 (float x, _IDEC_round rnd_mode, _IDEC_flags *pfpsf);
+extern D32 __binary64_to_bid32 (double x, _IDEC_round rnd_mode, _IDEC_flags *pfpsf);
+extern int __bid32_isSigned (D32 x);
+extern int __bid32_isNormal (D32 x);
+extern int __bid32_isZero (D32 x);
+extern int __bid32_quiet_equal (D32 x, D32 y, ErrorFlags *pfpsf);
+extern int __bid32_quiet_less (D32 x, D32 y, ErrorFlags *pfpsf);
+extern D64 __bid32_to_bid64 (D32 x, ErrorFlags *pfpsf);
+extern D128 __bid32_to_bid128 (D32 x, ErrorFlags *pfpsf);
 }
 
-class IDecimal {
-public:
-	// rounding modes
-	// NearestEven apparently means half-even
-	enum Round: unsigned int{
-		NearestEven = 0,	// 3.1415 -> 3.142,		2.71828182845 -> 2.7182818284
-		Downward    = 1,	// -3.1415 -> -3.142	3.1415 -> 3.141
-		Upward      = 2,	// -3.1415 -> 3.141     3.1415 -> 3.142
-		TowardZero  = 3,	// -3.1415 -> -3.141	3.1415 -> 3.141
-		NearestAway = 4		// 3.1415 -> 3.142,		2.71828182845 -> 2.7182818285
-	};
-	
-	enum Error: unsigned int {
-		None			= 0x00,
-		Invalid			= 0x01,
-		DivideByZero	= 0x04,
-		Overflow		= 0x08,
-		Underflow		= 0x10,
-		Inexact			= 0x20,
-		Undefined		= Error::Invalid | Error::DivideByZero | Error::Overflow | Error::Underflow,
-		Any				= 0xFF
-	};
-	
-	struct Exception : public std::runtime_error {
-		const ErrorFlags flags;
-		const IDecimal * decimal;
+// powers of ten up to 10^38, the largest that fits in 128 bits
+struct pow10_table {
+	unsigned __int128 p[39];
 
-		Exception(const std::string & message, ErrorFlags flags = Error::None, const IDecimal * decimal = nullptr) 
-			: std::runtime_error(message), flags(flags), decimal(decimal) {}
-		Exception(const char * message, ErrorFlags flags = Error::None, const IDecimal * decimal = nullptr) 
-			: Exception(std::string(message), flags, decimal) {}
-	};
-	
-	struct InvalidException : public Exception { using Exception::Exception; };
-	struct DivideByZeroException : public Exception { using Exception::Exception; };
-	struct OverflowException : public Exception { using Exception::Exception; };
-	struct UnderflowException : public Exception { using Exception::Exception; };
-	struct InexactException : public Exception { using Exception::Exception; };
-	struct MismatchedRoundingException : public std::runtime_error { 
-		const RoundMode mode1;
-		const RoundMode mode2;
-		MismatchedRoundingException(const RoundMode mode1, const RoundMode mode2) :
-			std::runtime_error("Mismatched rounding modes"), mode1(mode1), mode2(mode2) {}
-   	};
-	struct NonDecimalException: public std::runtime_error {
-		const std::string value; 
-		NonDecimalException(const char value) :
-			std::runtime_error("Non-decimal value received"), value(std::string(1, value)) {}
-		NonDecimalException(const char * value) :
-			std::runtime_error("Non-decimal value received"), value(value) {}
-		NonDecimalException(const std::string & value) :
-			std::runtime_error("Non-decimal value received"), value(value) {}
-	};
+	constexpr pow10_table() : p() {
+		p[0] = 1;
+		for (int i = 1; i < 39; ++i) {
+			p[i] = p[i - 1] * 10;
+		}
+	}
+
+	constexpr unsigned __int128 operator[](const int n) const { return p[n]; }
 };
 
-// Base class for decimal types
-template <class T>
-class DecimalBase : public IDecimal {
-protected:
-	T _val;
-	RoundMode _round_mode = Round::NearestEven;
-	ErrorFlags _errors = Error::None;
-	ErrorFlags _throw = Error::None;
-	
-	virtual void _attach_bid_functions() = 0;
-	virtual const unsigned short _precision() = 0;
-	virtual const unsigned short _emax() = 0;
-	virtual const unsigned short _emin() = 0;
-	
-	// functions used for conducting operations.
-	// since different functions are needed 
-	// depending on the data type of T,
-	// we have to attach these when the object is constructed
-	std::function<void(char *, D128, ErrorFlags*)> to_string;
-	std::function<uint8_t(D128, ErrorFlags*)> to_uint8_xrnint;
-	std::function<uint16_t(D128, ErrorFlags*)> to_uint16_xrnint;
-	std::function<uint32_t(D128, ErrorFlags*)> to_uint32_xrnint;
-	std::function<uint64_t(D128, ErrorFlags*)> to_uint64_xrnint;
-	std::function<int8_t(D128, ErrorFlags*)> to_int8_xrnint;
-	std::function<int16_t(D128, ErrorFlags*)> to_int16_xrnint;
-	std::function<int32_t(D128, ErrorFlags*)> to_int32_xrnint;
-	std::function<int64_t(D128, ErrorFlags*)> to_int64_xrnint;
-	std::function<float(D128, RoundMode, ErrorFlags*)> to_binary32;
-	std::function<double(D128, RoundMode, ErrorFlags*)> to_binary64;
-	std::function<int(D128)> _is_signed;
-	std::function<int(D128)> _is_normal;
-	std::function<int(D128)> _is_zero;
-	std::function<int(D128, D128, ErrorFlags*)> quiet_equal;
-	std::function<int(D128, D128, ErrorFlags *)> quiet_less;
-	std::function<D128(D128, ErrorFlags*)> round_integral_zero;
-	std::function<D128(D128)> abs;
-	std::function<D128(D128)> negate;
-	std::function<D128(D128, D128, RoundMode, ErrorFlags *)> _add;
-	std::function<D128(D128, D128, RoundMode, ErrorFlags *)> _sub;
-	std::function<D128(D128, D128, RoundMode, ErrorFlags *)> _mul;
-	std::function<D128(D128, D128, RoundMode, ErrorFlags *)> _div;
-	
-	// throws an exception if an invalid operation occurred	
-	static void check_flags(const ErrorFlags flags, const ErrorFlags throw_on_err = Error::Undefined) { 
-		if ((flags & Error::Invalid) == Error::Invalid) {
-			throw IDecimal::InvalidException("Invalid decimal operation", flags, nullptr);
-		} else if ((flags & throw_on_err & Error::DivideByZero) == Error::DivideByZero) {
-			throw IDecimal::DivideByZeroException("Attempt to divide by zero", flags, nullptr);
-		} else if ((flags & throw_on_err & Error::Overflow) == Error::Overflow) {
-			throw IDecimal::OverflowException("Overflow", flags, nullptr);
-		} else if ((flags & throw_on_err & Error::Underflow) == Error::Underflow) {
-			throw IDecimal::UnderflowException("Underflow", flags, nullptr);
-		} else if ((flags & throw_on_err & Error::Inexact) == Error::Inexact) {
-			throw IDecimal::InexactException("Inexact", flags, nullptr);
+inline constexpr pow10_table pow10_128;
+
+// the number of decimal digits in c, 0 for 0
+inline constexpr int decimal_digits(const unsigned __int128 c) {
+	const uint64_t high = static_cast<uint64_t>(c >> 64);
+	const uint64_t low = static_cast<uint64_t>(c);
+	const int bits = (high != 0)? 128 - __builtin_clzll(high) : (low != 0)? 64 - __builtin_clzll(low) : 0;
+	const int n = (bits * 1233) >> 12; // bits * log10(2)
+	return n + 1 - ((c < pow10_128[n])? 1 : 0);
+}
+
+// Orders two finite values given by sign, coefficient and exponent:
+// -1, 0 or 1 as x is less than, equal to or greater than y.
+inline constexpr int compare_finite(const bool xneg, const unsigned __int128 cx, const int ex, 
+									const bool yneg, const unsigned __int128 cy, const int ey) {
+	if (cx == 0 || cy == 0) {
+		if (cx == 0 && cy == 0) {
+			return 0;
 		}
+		return (cx == 0)? (yneg? 1 : -1) : (xneg? -1 : 1);
+	}
+	if (xneg != yneg) {
+		return xneg? -1 : 1;
 	}
 
-	// saves the flags so they can be read later,
-	// and checks them for invalid operations
-	void save_flags(const ErrorFlags flags, const ErrorFlags throw_on_err = Error::Undefined) {
-		this->_errors |= flags;
-		this->check_flags(flags, throw_on_err);
+	// compare the magnitudes by their adjusted exponents first,
+	// then, when those match, by the aligned coefficients,
+	// which have the same number of digits and so cannot overflow
+	int magnitude = 0;
+	const int ax = ex + decimal_digits(cx);
+	const int ay = ey + decimal_digits(cy);
+	if (ax != ay) {
+		magnitude = (ax > ay)? 1 : -1;
+	} else if (ex == ey) {
+		magnitude = (cx > cy)? 1 : (cx < cy)? -1 : 0;
+	} else {
+		const unsigned __int128 sx = (ex > ey)? cx * pow10_128[ex - ey] : cx;
+		const unsigned __int128 sy = (ey > ex)? cy * pow10_128[ey - ex] : cy;
+		magnitude = (sx > sy)? 1 : (sx < sy)? -1 : 0;
 	}
+	return xneg? -magnitude : magnitude;
+}
 
-	// helper method to invoke an operation
-	// this method does not save any flags
-	// (it does not modify the object)	
-	static void invoke(std::function<void(ErrorFlags*)> func, const ErrorFlags throw_on_err = Error::Undefined) {
-		ErrorFlags flags = Error::None;
-		func(&flags);
-		check_flags(flags, throw_on_err);
+// Divides c by 10^n, rounding as the mode and sign require.
+// sticky means that something non-zero but less than
+// half a unit of the last dropped digit lies below c (n must be > 0 then).
+inline constexpr unsigned __int128 shift_digits(const unsigned __int128 c, const int n, const bool sticky, const bool negative, const RoundMode rnd_mode, ErrorFlags & flags) {
+	if (n == 0) {
+		return c;
 	}
 
-	// helper method to invoke an operation
-	// this method does not save any flags
-	// (it does not modify the object)	
-	// this method returns the result of the operation
-	template <class TResult>
-	static TResult invoke(std::function<TResult(ErrorFlags*)> func, const ErrorFlags throw_on_err = Error::Undefined) {
-		ErrorFlags flags = Error::None;
-		TResult result = func(&flags);
-		check_flags(flags, throw_on_err);
-		return result;
+	unsigned __int128 q = 0;
+	int half = -1; // the dropped part compared to half a unit
+	if (n > 38) {
+		// everything is dropped, and it is less than half a unit
+		if (c == 0 && !sticky) {
+			return 0;
+		}
+	} else {
+		const unsigned __int128 p = pow10_128[n];
+		const unsigned __int128 r = c % p;
+		q = c / p;
+		if (r == 0 && !sticky) {
+			return q;
+		}
+		half = (r < p / 2)? -1 : (r > p / 2 || sticky)? 1 : 0;
 	}
-	
-	// encapsulates construction / destruction of a char*
-	struct cstr {
-		char* val;
-		cstr(std::string & s) {
-			this->val = new char[s.length() + 1];
-			strcpy(this->val, s.c_str());
+
+	flags |= 0x20; // IDecimal::Error::Inexact
+	bool up = false;
+	switch (rnd_mode) {
+		case 0: up = (half > 0) || (half == 0 && (q & 1) == 1); break; // IDecimal::Round::NearestEven
+		case 4: up = (half >= 0); break; // NearestAway
+		case 2: up = !negative; break; // Upward
+		case 1: up = negative; break; // Downward
+		default: break; // TowardZero
+	}
+	return up? q + 1 : q;
+}
+
+// A native implementation of BID64 arithmetic that follows libbid bit for bit.
+// Everything is constexpr and inline, so the compiler can fold decimal math 
+// into constant expressions and optimize it across loops.
+// Every operation rounds exactly once and raises the same flags as libbid.
+struct bid64_engine {
+	typedef unsigned __int128 uint128;
+
+	// == encoding == //
+	// After the sign come either a 10-bit exponent and a 53-bit coefficient,
+	// or, when the next two bits are 11, a 10-bit exponent and the low 51 bits 
+	// of a coefficient whose implied high bits are 100.
+	// 11110 marks an infinity and 11111 a NaN, signaling if the next bit is set.
+	static constexpr uint64_t sign_mask = 0x8000000000000000ull;
+	static constexpr uint64_t steering_mask = 0x6000000000000000ull;
+	static constexpr uint64_t inf = 0x7800000000000000ull;
+	static constexpr uint64_t nan = 0x7c00000000000000ull;
+	static constexpr uint64_t snan = 0x7e00000000000000ull;
+	static constexpr uint64_t small_coefficient_mask = 0x001fffffffffffffull;
+	static constexpr uint64_t large_coefficient_mask = 0x0007ffffffffffffull;
+	static constexpr uint64_t large_coefficient_bits = 0x0020000000000000ull;
+	static constexpr uint64_t coefficient_limit = 10000000000000000ull; // 10^16
+	static constexpr int precision = 16;
+	static constexpr int bias = 398;
+	static constexpr int max_exponent = 767; // biased
+
+	// the same values as IDecimal::Error and IDecimal::Round
+	static constexpr ErrorFlags invalid = 0x01;
+	static constexpr ErrorFlags divide_by_zero = 0x04;
+	static constexpr ErrorFlags overflow = 0x08;
+	static constexpr ErrorFlags underflow = 0x10;
+	static constexpr ErrorFlags inexact = 0x20;
+	static constexpr RoundMode nearest_even = 0;
+	static constexpr RoundMode downward = 1;
+	static constexpr RoundMode upward = 2;
+	static constexpr RoundMode toward_zero = 3;
+	static constexpr RoundMode nearest_away = 4;
+
+	// a finite value: (-1)^negative * c * 10^(e - bias)
+	struct unpacked {
+		bool negative;
+		uint64_t c;
+		int e;
+	};
+
+	static constexpr bool is_special(const uint64_t x) { return (x & inf) == inf; }
+	static constexpr bool is_inf(const uint64_t x) { return (x & nan) == inf; }
+	static constexpr bool is_nan(const uint64_t x) { return (x & nan) == nan; }
+	static constexpr bool is_snan(const uint64_t x) { return (x & snan) == snan; }
+
+	// decodes a finite value; non-canonical coefficients read as zero
+	static constexpr unpacked unpack(const uint64_t x) {
+		if ((x & steering_mask) == steering_mask) {
+			const uint64_t c = (x & large_coefficient_mask) | large_coefficient_bits;
+			return { (x & sign_mask) != 0, (c < coefficient_limit)? c : 0, static_cast<int>((x >> 51) & 0x3ff) };
 		}
-		cstr(const char * c) {
-			this->val = new char[strlen(c) + 1];
-			strcpy(this->val, c);
+		return { (x & sign_mask) != 0, x & small_coefficient_mask, static_cast<int>((x >> 53) & 0x3ff) };
+	}
+
+	// encodes a coefficient below 10^16 and an exponent within range
+	static constexpr uint64_t encode(const bool negative, const uint64_t c, const int e) {
+		const uint64_t sign = negative? sign_mask : 0;
+		if (c < large_coefficient_bits) {
+			return sign | (static_cast<uint64_t>(e) << 53) | c;
 		}
-		~cstr() {
-			delete[] this->val;
+		return sign | steering_mask | (static_cast<uint64_t>(e) << 51) | (c & large_coefficient_mask);
+	}
+
+	static constexpr int digits(const uint128 c) { return decimal_digits(c); }
+
+	// a NaN operand is returned quiet, with a non-canonical payload cleared
+	static constexpr uint64_t quiet(const uint64_t x) {
+		return ((x & 0x0003ffffffffffffull) >= 1000000000000000ull)? (x & 0xfc00000000000000ull) : (x & 0xfc03ffffffffffffull);
+	}
+
+	static constexpr uint64_t propagate(const uint64_t x, const uint64_t y, ErrorFlags & flags) {
+		if (is_snan(x) || is_snan(y)) {
+			flags |= invalid;
 		}
-	};
-		
-	static const std::string random_str(const short precision, const short emin, const short emax) {
-		// Algorithm derived from IEEE754-2008, Page 8
-		// Signed zero and non-zero floating-point numbers of the form (−1)^s*b^q*c, where
-		// 	s is 0 or 1.
-		// 	q is any integer emin <= q + p − 1 <= emax.
-		// 	c is a number represented by a digit string of the form
-		//	d0 d1 d2 ... dp−1 where di is an integer digit 0 <= di < b (c is therefore an integer with 0 <= c < b^p).
+		return quiet(is_nan(x)? x : y);
+	}
 
-		// setup a random number generator,
-		// make it static so we don't have to rebuild it with every call
- 		static std::random_device rd;
-    	static std::mt19937_64 gen(rd());
 
-		// use a bernoulli probability distribution to decide whether the number will be negative
-		static auto sign_dist = std::bernoulli_distribution(0.5);
+	// Rounds a coefficient of any size with a biased exponent that may be out of range
+	// to the nearest BID64, raising overflow, underflow and inexact as libbid does.
+	static constexpr uint64_t pack(const bool negative, uint128 c, int e, const bool sticky, const RoundMode rnd_mode, ErrorFlags & flags) {
+		int n = digits(c) - precision;
+		if (n < 0) {
+			n = 0;
+		}
 
-		// use a uniform integer distribution to generate the digits of the significand
-		// create two 64-bit integers, and use modulus to extract the first p / 2 bits of each
-		static auto significand_dist = std::uniform_int_distribution<uint64_t>(0, std::numeric_limits<uint64_t>::max());
-		static const long mask = pow(10, precision >> 1);
-		
-		// use a uniform integer distribution to generate the exponent in the range [emin - p + 1, emax - p + 1]
-		static auto exponent_dist = std::uniform_int_distribution<short>(emin, emax);
-	
-		// generate the random parameters	
-		bool negative = sign_dist(gen);
-		uint64_t significand_low = significand_dist(gen) % mask;
-		uint64_t significand_high = significand_dist(gen) % mask;
-		short exponent = exponent_dist(gen);
+		// below the smallest exponent the result is subnormal, so more digits go
+		const bool tiny = (e + n < 0);
+		if (tiny) {
+			n = -e;
+		}
 
-		// create a string with the following format:
-		// "sDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDE+DDDD" + \0
-		auto n = precision + 8;
-		char result[n];
-		sprintf(result, "%c%llu%lluE%+d", (negative? '-' : '+'), significand_high, significand_low, exponent);
-		return result;
+		if (n > 0) {
+			ErrorFlags f = 0;
+			c = shift_digits(c, n, sticky, negative, rnd_mode, f);
+			e += n;
+			if (c == coefficient_limit) {
+				// rounding carried into a 17th digit
+				c /= 10;
+				++e;
+			}
+			if (f != 0) {
+				flags |= tiny? (f | underflow) : f;
+			}
+		}
+
+		if (e > max_exponent) {
+			if (c == 0) {
+				e = max_exponent;
+			} else if (digits(c) + (e - max_exponent) <= precision) {
+				// an exact result with too large an exponent fits with trailing zeros
+				c *= pow10_128[e - max_exponent];
+				e = max_exponent;
+			} else {
+				flags |= overflow | inexact;
+				const bool to_inf = (rnd_mode == nearest_even) || (rnd_mode == nearest_away) ||
+					(rnd_mode == upward && !negative) || (rnd_mode == downward && negative);
+				return to_inf? ((negative? sign_mask : 0) | inf) : encode(negative, coefficient_limit - 1, max_exponent);
+			}
+		}
+
+		return encode(negative, static_cast<uint64_t>(c), e);
 	}
 
-	// All derived constructors must eventually invoke this base constructor	
-	DecimalBase(const T value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined)  
-		: _val(value), _round_mode(round_mode), _throw(throw_on_err) {
-			if ((throw_on_err & Error::Invalid) != Error::Invalid) {
-				throw Exception("Error::Invalid is required for all operations.");
+	// == arithmetic == //
+	static constexpr uint64_t add(const uint64_t x, const uint64_t y, const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+		if (is_special(x) || is_special(y)) {
+			if (is_nan(x) || is_nan(y)) {
+				return propagate(x, y, *pfpsf);
+			}
+			if (is_inf(x)) {
+				if (is_inf(y) && ((x ^ y) & sign_mask) != 0) {
+					*pfpsf |= invalid;
+					return nan;
+				}
+				return x & (sign_mask | inf);
 			}
+			return y & (sign_mask | inf);
 		}
-	
-public:	 	
-	void throw_on(const Error & error) { this->_throw |= error; }
-	void throw_off(const Error & error) { this->_throw ^= error; }
 
-	const unsigned int round_mode() const { return this->_round_mode; }
-	const unsigned int errors() const { return this->_errors; }
-	const unsigned int throw_on_err() const { return this->_throw; }
+		// a has the larger exponent
+		unpacked a = unpack(x);
+		unpacked b = unpack(y);
+		if (a.e < b.e) {
+			const unpacked t = a;
+			a = b;
+			b = t;
+		}
 
-	const bool divide_by_zero() const { return ((this->_errors & Error::DivideByZero) == Error::DivideByZero); }
-	const bool overflow() const { return ((this->_errors & Error::Overflow)== Error::Overflow); }
-	const bool underflow() const { return ((this->_errors & Error::Underflow) == Error::Underflow); }
-	const bool inexact() const { return ((this->_errors & Error::Inexact) == Error::Inexact); }
+		if (a.c == 0 && b.c == 0) {
+			const bool negative = (a.negative == b.negative)? a.negative : (rnd_mode == downward);
+			return encode(negative, 0, b.e);
+		}
+		if (a.c == 0) {
+			return encode(b.negative, b.c, b.e);
+		}
 
-	// combines the given error flags to produce a comma-separated list
-	static const std::string error_str(const unsigned int flags) {
-		std::stringstream ss;
-		std::vector<std::string> v;
+		// the result prefers the smaller exponent, 
+		// so a is scaled up as far as its 16 digits allow
+		int diff = a.e - b.e;
+		int k = precision - digits(a.c);
+		if (k > diff) {
+			k = diff;
+		}
+		uint128 ca = a.c * pow10_128[k];
+		int e = a.e - k;
+		diff -= k;
+		if (b.c == 0) {
+			return encode(a.negative, static_cast<uint64_t>(ca), e);
+		}
 
-		if ((flags & Error::Invalid) == Error::Invalid) {
-			v.push_back("invalid");
-		} else if ((flags & Error::DivideByZero) == DivideByZero) {
-			v.push_back("zerodivide");
-		} else if ((flags & Error::Overflow) == Error::Overflow) {
-			v.push_back("overflow");
-		} else if ((flags & Error::Underflow) == Error::Underflow) {
-			v.push_back("underflow");
-		} else if ((flags & Error::Inexact) == Error::Inexact) {
-			v.push_back("inexact");
+		uint128 cb = b.c;
+		if (diff > 19) {
+			// b is less than a thousandth of the last digit of a,
+			// so a unit three digits further down rounds the same way
+			ca *= 1000;
+			e -= 3;
+			cb = 1;
+		} else {
+			ca *= pow10_128[diff];
+			e -= diff;
 		}
 
-		if (v.size() > 0) {
-			for(size_t i = 0; i < v.size(); ++i) {
-				if (i != 0)
-					ss << ", ";
-				ss << v[i];
-			}
+		uint128 c = 0;
+		bool negative = a.negative;
+		if (a.negative == b.negative) {
+			c = ca + cb;
+		} else if (ca > cb) {
+			c = ca - cb;
+		} else if (ca < cb) {
+			c = cb - ca;
+			negative = b.negative;
 		} else {
-			ss << "None";
+			// an exact zero sum is negative only when rounding downward
+			negative = (rnd_mode == downward);
 		}
-			
-		return ss.str();
-	}
-	
-	// converts the decimal to a string
-	const std::string str() {
-		assert(this->_precision() > 0);
-		auto len = this->_precision() + 8; // 6 for the exponent, 1 for the sign, 1 for \0
-		char buf[len];
-		this->invoke([&](ErrorFlags * flags) {
-			this->to_string (buf, this->_val, flags);
-		}, this->_throw);	
-			
-		buf[len - 1] = '\0'; // in case to_string fails to add one
-		return buf;
+		return pack(negative, c, e, false, rnd_mode, *pfpsf);
 	}
-	
-	const std::string sci() {
-		auto buf = this->str().c_str();
-		auto len = strlen(buf);
-		assert(len > 3);
-		char buf2[len];
-		
-		if (strcmp(&buf[1], "NaN") == 0 ||
-			strcmp(&buf[1], "SNaN") == 0 ||
-			strcmp(&buf[1], "Inf") == 0
-		) {
-			// return special numbers directly
-			strcpy(buf2, buf);
-		} else {
-			// find the first non-zero digit of the significand
-			auto start = 1;
-			while (start < len && buf[start] == '0') { ++start; }
 
-			// find the end of the significand (beginning of the exponent)
-			auto end = len - 1; // the end of the significand
-			while (buf[end+1] != 'E') { --end; }
-			assert(end < len - 1);	// the exponent must exist
-			assert(end > 0);		// there must also be a sign and significand
+	static constexpr uint64_t sub(const uint64_t x, const uint64_t y, const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+		return add(x, is_nan(y)? y : (y ^ sign_mask), rnd_mode, pfpsf);
+	}
 
-			if (end < start) {
-				return "0E+0";
+	static constexpr uint64_t mul(const uint64_t x, const uint64_t y, const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+		if (is_special(x) || is_special(y)) {
+			if (is_nan(x) || is_nan(y)) {
+				return propagate(x, y, *pfpsf);
 			}
-		
-			// compute the exponent	
-			auto exp = atoi(&buf[end+2]); // the value of the exponent
-			
-			// shift the decimal point and adjust the exponent to match
-			int dp = end - start;
-			exp += dp;
-		
-			// rewrite the decimal in scientific notation	
-			buf2[0] = buf[0]; // copy the sign
-			buf2[len-1] = '\0';
+			if ((!is_special(x) && unpack(x).c == 0) || (!is_special(y) && unpack(y).c == 0)) {
+				*pfpsf |= invalid;
+				return nan;
+			}
+			return ((x ^ y) & sign_mask) | inf;
+		}
+
+		const unpacked a = unpack(x);
+		const unpacked b = unpack(y);
+		const uint128 c = static_cast<uint128>(a.c) * b.c;
+		return pack(a.negative != b.negative, c, a.e + b.e - bias, false, rnd_mode, *pfpsf);
+	}
 
-			auto dest = (buf[0] == '-'? &buf2[1] : buf2);
+	static constexpr uint64_t div(const uint64_t x, const uint64_t y, const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+		if (is_special(x) || is_special(y)) {
+			if (is_nan(x) || is_nan(y)) {
+				return propagate(x, y, *pfpsf);
+			}
+			if (is_inf(x)) {
+				if (is_inf(y)) {
+					*pfpsf |= invalid;
+					return nan;
+				}
+				return ((x ^ y) & sign_mask) | inf;
+			}
+			// a finite number divided by infinity
+			return ((x ^ y) & sign_mask);
+		}
 
-			if (dp <= 0) {
-				sprintf(dest, "%cE%+d", buf[start], exp);
-			} else {
-				sprintf(dest, "%c.%.*sE%+d", buf[start], dp, buf + start + 1, exp);
+		const unpacked a = unpack(x);
+		const unpacked b = unpack(y);
+		const bool negative = (a.negative != b.negative);
+		const int preferred = a.e - b.e + bias;
+		if (b.c == 0) {
+			if (a.c == 0) {
+				*pfpsf |= invalid;
+				return nan;
 			}
+			*pfpsf |= divide_by_zero;
+			return (negative? sign_mask : 0) | inf;
+		}
+		if (a.c == 0) {
+			return encode(negative, 0, (preferred < 0)? 0 : (preferred > max_exponent)? max_exponent : preferred);
 		}
 
-		return buf2;
+		// scale the dividend so that the quotient has 17 or 18 digits,
+		// leaving at least one digit to round at
+		const int k = precision + 1 + digits(b.c) - digits(a.c);
+		const uint128 n = a.c * pow10_128[k];
+		uint128 q = n / b.c;
+		const bool sticky = (n % b.c) != 0;
+		int e = preferred - k;
+
+		if (!sticky) {
+			// an exact quotient moves as close to the preferred exponent as it can
+			while (e < preferred && q % 10 == 0) {
+				q /= 10;
+				++e;
+			}
+		}
+		return pack(negative, q, e, sticky, rnd_mode, *pfpsf);
 	}
-	
-	const bool is_negative() const {
-		return (this->_is_signed(this->_val) > 0);
+
+	// == comparisons == //
+	// -1, 0 or 1 as x is less than, equal to or greater than y, 2 when unordered
+	static constexpr int compare(const uint64_t x, const uint64_t y, ErrorFlags * pfpsf) {
+		if (is_nan(x) || is_nan(y)) {
+			if (is_snan(x) || is_snan(y)) {
+				*pfpsf |= invalid;
+			}
+			return 2;
+		}
+
+		const bool xneg = (x & sign_mask) != 0;
+		const bool yneg = (y & sign_mask) != 0;
+		if (is_inf(x)) {
+			return (is_inf(y) && xneg == yneg)? 0 : (xneg? -1 : 1);
+		}
+		if (is_inf(y)) {
+			return yneg? 1 : -1;
+		}
+
+		const unpacked a = unpack(x);
+		const unpacked b = unpack(y);
+		return compare_finite(xneg, a.c, a.e, yneg, b.c, b.e);
 	}
-	
-	const bool is_normal() const {
-		return (this->_is_normal(this->_val) > 0);
+
+	static constexpr int quiet_equal(const uint64_t x, const uint64_t y, ErrorFlags * pfpsf) {
+		return compare(x, y, pfpsf) == 0;
 	}
-	
-	const bool is_zero() const {
-		return (this->_is_zero(this->_val) > 0);
+
+	static constexpr int quiet_less(const uint64_t x, const uint64_t y, ErrorFlags * pfpsf) {
+		return compare(x, y, pfpsf) == -1;
 	}
-	
-	// == operators to convert to native types == //
-	explicit operator unsigned char() const { 
-		return this->invoke<unsigned char>([&](ErrorFlags * flags) {
-			return this->to_uint8_xrnint (this->_val, flags);
-		}, this->_throw);
+
+	// == rounding == //
+	// rounds to an integral value; only the exact variant raises inexact
+	static constexpr uint64_t round_integral(const uint64_t x, const RoundMode rnd_mode, const bool exact, ErrorFlags * pfpsf) {
+		if (is_nan(x)) {
+			return propagate(x, x, *pfpsf);
+		}
+		if (is_inf(x)) {
+			return x & (sign_mask | inf);
+		}
+
+		const unpacked a = unpack(x);
+		if (a.e >= bias) {
+			return encode(a.negative, a.c, a.e);
+		}
+
+		ErrorFlags flags = 0;
+		const uint128 c = shift_digits(a.c, bias - a.e, false, a.negative, rnd_mode, flags);
+		if (exact) {
+			*pfpsf |= flags;
+		}
+		return encode(a.negative, static_cast<uint64_t>(c), bias);
 	}
-	
-	explicit operator unsigned short() const { 
-		return this->invoke<unsigned short>([&](ErrorFlags * flags) {
-			return this->to_uint16_xrnint (this->_val, flags);
-		}, this->_throw);
+
+	static constexpr uint64_t round_integral_zero(const uint64_t x, ErrorFlags * pfpsf) {
+		return round_integral(x, toward_zero, false, pfpsf);
 	}
 
-	explicit operator unsigned int() const { 
-		return this->invoke<unsigned int>([&](ErrorFlags * flags) {
-			return this->to_uint32_xrnint (this->_val, flags);
-		}, this->_throw);
+	static constexpr uint64_t round_integral_exact(const uint64_t x, const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+		return round_integral(x, rnd_mode, true, pfpsf);
 	}
-	
-	explicit operator unsigned long() const { 
+
+	// gives x the exponent of y, rounding as needed;
+	// invalid if the coefficient would need more than 16 digits
+	static constexpr uint64_t quantize(const uint64_t x, const uint64_t y, const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+		if (is_special(x) || is_special(y)) {
+			if (is_nan(x) || is_nan(y)) {
+				return propagate(x, y, *pfpsf);
+			}
+			if (is_inf(x) && is_inf(y)) {
+				return x & (sign_mask | inf);
+			}
+			*pfpsf |= invalid;
+			return nan;
+		}
+
+		const unpacked a = unpack(x);
+		const int e = unpack(y).e;
+		if (a.e >= e) {
+			if (a.c != 0 && digits(a.c) + (a.e - e) > precision) {
+				*pfpsf |= invalid;
+				return nan;
+			}
+			return encode(a.negative, static_cast<uint64_t>(a.c * pow10_128[a.e - e]), e);
+		}
+
+		ErrorFlags flags = 0;
+		const uint128 c = shift_digits(a.c, e - a.e, false, a.negative, rnd_mode, flags);
+		if (c == coefficient_limit) {
+			*pfpsf |= invalid;
+			return nan;
+		}
+		*pfpsf |= flags;
+		return encode(a.negative, static_cast<uint64_t>(c), e);
+	}
+
+	// == sign == //
+	static constexpr uint64_t abs(const uint64_t x) { return x & ~sign_mask; }
+	static constexpr uint64_t negate(const uint64_t x) { return x ^ sign_mask; }
+	static constexpr int is_signed(const uint64_t x) { return (x & sign_mask) != 0; }
+};
+
+// Classifies and orders values of a storage type from the bits alone.
+// Each bid_traits inherits this and provides is_signed, is_nan, is_snan, is_inf, 
+// canonical_coefficient and exponent for its encoding.
+// The classes are numbered as in libbid (bid128_class etc.), see IDecimal::Class.
+template <class T, class B>
+struct bid_classification {
+	static constexpr int is_finite(const T x) { return !B::is_nan(x) && !B::is_inf(x); }
+	static constexpr int is_zero(const T x) { return is_finite(x) && B::canonical_coefficient(x) == 0; }
+
+	// normal values have an adjusted exponent (that of the leading digit) of at least emin + precision - 1
+	static constexpr int is_normal(const T x) {
+		if (!is_finite(x)) {
+			return 0;
+		}
+		const auto c = B::canonical_coefficient(x);
+		return c != 0 && B::exponent(x) + decimal_digits(c) >= B::emin + B::precision;
+	}
+
+	static constexpr int is_subnormal(const T x) { 
+		return is_finite(x) && B::canonical_coefficient(x) != 0 && !is_normal(x); 
+	}
+
+	static constexpr int classify(const T x) {
+		if (B::is_nan(x)) {
+			return B::is_snan(x)? 0 : 1;
+		}
+		const bool negative = B::is_signed(x);
+		if (B::is_inf(x)) {
+			return negative? 2 : 9;
+		}
+		if (B::canonical_coefficient(x) == 0) {
+			return negative? 5 : 6;
+		}
+		if (is_normal(x)) {
+			return negative? 3 : 8;
+		}
+		return negative? 4 : 7;
+	}
+
+	// -1, 0 or 1 as x is less than, equal to or greater than y, 2 when unordered.
+	// Computed from the bits in one pass; values with the same exponent
+	// compare by their coefficients alone. A signaling NaN raises invalid, as in libbid.
+	static constexpr int compare(const T x, const T y, ErrorFlags * pfpsf) {
+		constexpr ErrorFlags invalid = 0x01; // IDecimal::Error::Invalid
+		if (B::is_nan(x) || B::is_nan(y)) {
+			if (B::is_snan(x) || B::is_snan(y)) {
+				*pfpsf |= invalid;
+			}
+			return 2;
+		}
+
+		const bool xneg = B::is_signed(x);
+		const bool yneg = B::is_signed(y);
+		if (B::is_inf(x)) {
+			return (B::is_inf(y) && xneg == yneg)? 0 : (xneg? -1 : 1);
+		}
+		if (B::is_inf(y)) {
+			return yneg? 1 : -1;
+		}
+		return compare_finite(xneg, B::canonical_coefficient(x), B::exponent(x), yneg, B::canonical_coefficient(y), B::exponent(y));
+	}
+};
+
+// Maps the operations on a storage type onto Intel's functions for that type.
+// Everything is resolved at compile time,
+// so each operation is a single direct call into libbid.
+template <class T>
+struct bid_traits;
+
+template <>
+struct bid_traits<D128> : bid_classification<D128, bid_traits<D128>> {
+	// format parameters: digits in the significand, 
+	// and the range of the exponent applied to the integral significand
+	static constexpr short precision = 34;
+	static constexpr short emax = 6111;
+	static constexpr short emin = -6176;
+
+	// == encoding == //
+	// w[1] holds the sign, the combination field and the top of the coefficient.
+	// When the two bits after the sign are 11 the value is special or non-canonical,
+	// otherwise they start a 14-bit exponent followed by a 113-bit coefficient.
+	typedef unsigned __int128 uint128;
+	static constexpr uint64_t sign_mask = 0x8000000000000000ull;
+	static constexpr uint64_t steering_mask = 0x6000000000000000ull;
+	static constexpr uint64_t exponent_mask = 0x7ffe000000000000ull;
+	static constexpr uint64_t coefficient_mask = 0x0001ffffffffffffull;
+	static constexpr uint128 coefficient_limit = static_cast<uint128>(100000000000000000ull) * 100000000000000000ull; // 10^34
+	static constexpr RoundMode round_downward = 1; // IDecimal::Round::Downward
+
+	static constexpr uint128 coefficient(const D128 x) { 
+		return (static_cast<uint128>(x.w[1] & coefficient_mask) << 64) | x.w[0]; 
+	}
+
+	// the coefficient and exponent of a finite value;
+	// a non-canonical coefficient (any in the steering form) reads as zero
+	static constexpr uint128 canonical_coefficient(const D128 x) {
+		const uint128 c = coefficient(x);
+		return ((x.w[1] & steering_mask) == steering_mask || c >= coefficient_limit)? 0 : c;
+	}
+	static constexpr int exponent(const D128 x) {
+		return ((x.w[1] & steering_mask) == steering_mask)? static_cast<int>((x.w[1] >> 47) & 0x3fff) + emin 
+			: static_cast<int>((x.w[1] & exponent_mask) >> 49) + emin;
+	}
+
+	// encodes a coefficient below 10^34 and an exponent within [emin, emax]
+	static constexpr D128 encode(const bool negative, const uint128 c, const int exponent) {
+		return D128{{static_cast<uint64_t>(c), 
+			(negative? sign_mask : 0) | (static_cast<uint64_t>(exponent - emin) << 49) | static_cast<uint64_t>(c >> 64)}};
+	}
+	static constexpr D128 encode_inf(const bool negative) { return D128{{0, (negative? sign_mask : 0) | 0x7800000000000000ull}}; }
+	static constexpr D128 encode_nan(const bool negative) { return D128{{0, (negative? sign_mask : 0) | 0x7c00000000000000ull}}; }
+	static constexpr D128 encode_snan(const bool negative) { return D128{{0, (negative? sign_mask : 0) | 0x7e00000000000000ull}}; }
+
+	// Adds two finite, canonical values with the same exponent 
+	// when the sum needs no rounding, which covers most money arithmetic. 
+	// The result is exact and raises no flags, so it matches libbid bit for bit.
+	// Returns false when libbid must do the work.
+	static inline bool add_exact(const D128 x, const D128 y, const RoundMode rnd_mode, D128 & z) {
+		if ((x.w[1] & steering_mask) == steering_mask || 
+			(y.w[1] & steering_mask) == steering_mask || 
+			((x.w[1] ^ y.w[1]) & exponent_mask) != 0) {
+			return false;
+		}
+
+		const uint128 cx = coefficient(x);
+		const uint128 cy = coefficient(y);
+		if (cx >= coefficient_limit || cy >= coefficient_limit) {
+			return false;
+		}
+
+		uint128 c;
+		uint64_t sign;
+		if (((x.w[1] ^ y.w[1]) & sign_mask) == 0) {
+			c = cx + cy;
+			if (c >= coefficient_limit) {
+				return false;
+			}
+			sign = x.w[1] & sign_mask;
+		} else if (cx != cy) {
+			c = (cx > cy)? cx - cy : cy - cx;
+			sign = ((cx > cy)? x.w[1] : y.w[1]) & sign_mask;
+		} else {
+			// an exact zero sum is negative only when rounding downward
+			c = 0;
+			sign = (rnd_mode == round_downward)? sign_mask : 0;
+		}
+
+		z.w[0] = static_cast<uint64_t>(c);
+		z.w[1] = sign | (x.w[1] & exponent_mask) | static_cast<uint64_t>(c >> 64);
+		return true;
+	}
+
+	// Multiplies two finite values whose coefficients fit in 64 bits
+	// (e.g. price x quantity) when the product needs no rounding:
+	// the coefficients are multiplied 64x64->128 and the exponents are added.
+	// Returns false when libbid must do the work.
+	static inline bool mul_exact(const D128 x, const D128 y, D128 & z) {
+		if ((x.w[1] & steering_mask) == steering_mask || 
+			(y.w[1] & steering_mask) == steering_mask ||
+			(x.w[1] & coefficient_mask) != 0 || 
+			(y.w[1] & coefficient_mask) != 0) {
+			return false;
+		}
+
+		const uint128 c = static_cast<uint128>(x.w[0]) * y.w[0];
+		if (c >= coefficient_limit) {
+			return false;
+		}
+
+		// the biased exponents sum to the biased result plus the bias
+		constexpr int64_t bias = -emin;
+		constexpr int64_t max_exponent = emax + bias;
+		const int64_t e = static_cast<int64_t>((x.w[1] & exponent_mask) >> 49) 
+			+ static_cast<int64_t>((y.w[1] & exponent_mask) >> 49) - bias;
+		if (e < 0 || e > max_exponent) {
+			return false;
+		}
+
+		z.w[0] = static_cast<uint64_t>(c);
+		z.w[1] = ((x.w[1] ^ y.w[1]) & sign_mask) | (static_cast<uint64_t>(e) << 49) | static_cast<uint64_t>(c >> 64);
+		return true;
+	}
+
+	static inline D128 from_string(char * ps, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_from_string(ps, rnd_mode, pfpsf); }
+	// every 32-bit integer fits, so these are always exact
+	static inline D128 from_uint32(const uint32_t x, const RoundMode, ErrorFlags *) { return bid128_from_uint32(x); }
+	static inline D128 from_int32(const int32_t x, const RoundMode, ErrorFlags *) { return bid128_from_int32(x); }
+	// every 64-bit integer fits in 34 digits, so these are always exact
+	static inline D128 from_uint64(const uint64_t x, const RoundMode, ErrorFlags *) { return bid128_from_uint64(x); }
+	static inline D128 from_int64(const int64_t x, const RoundMode, ErrorFlags *) { return bid128_from_int64(x); }
+	static inline D128 from_binary32(const float x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return binary32_to_bid128(x, rnd_mode, pfpsf); }
+	static inline D128 from_binary64(const double x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return binary64_to_bid128(x, rnd_mode, pfpsf); }
+	// widening from a narrower format is always exact
+	static inline D128 from_bid(const D64 x, const RoundMode, ErrorFlags * pfpsf) { return bid64_to_bid128(x, pfpsf); }
+	static inline D128 from_bid(const D32 x, const RoundMode, ErrorFlags * pfpsf) { return bid32_to_bid128(x, pfpsf); }
+
+	static inline void to_string(char * ps, const D128 x, ErrorFlags * pfpsf) { bid128_to_string(ps, x, pfpsf); }
+	static inline uint8_t to_uint8_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_uint8_xrnint(x, pfpsf); }
+	static inline uint16_t to_uint16_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_uint16_xrnint(x, pfpsf); }
+	static inline uint32_t to_uint32_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_uint32_xrnint(x, pfpsf); }
+	static inline uint64_t to_uint64_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_uint64_xrnint(x, pfpsf); }
+	static inline int8_t to_int8_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_int8_xrnint(x, pfpsf); }
+	static inline int16_t to_int16_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_int16_xrnint(x, pfpsf); }
+	static inline int32_t to_int32_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_int32_xrnint(x, pfpsf); }
+	static inline int64_t to_int64_xrnint(const D128 x, ErrorFlags * pfpsf) { return bid128_to_int64_xrnint(x, pfpsf); }
+	static inline float to_binary32(const D128 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_to_binary32(x, rnd_mode, pfpsf); }
+	static inline double to_binary64(const D128 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_to_binary64(x, rnd_mode, pfpsf); }
+
+	// == classification == //
+	// masks on the high word; the rest comes from bid_classification
+	static constexpr int is_signed(const D128 x) { return (x.w[1] & sign_mask) != 0; }
+	static constexpr int is_inf(const D128 x) { return (x.w[1] & 0x7c00000000000000ull) == 0x7800000000000000ull; }
+	static constexpr int is_nan(const D128 x) { return (x.w[1] & 0x7c00000000000000ull) == 0x7c00000000000000ull; }
+	static constexpr int is_snan(const D128 x) { return (x.w[1] & 0x7e00000000000000ull) == 0x7e00000000000000ull; }
+
+	// Canonical encodings are the ones libbid produces: no coefficient beyond 10^34 - 1,
+	// nothing after an infinity's sign and combination field, 
+	// and a NaN payload below 10^33 with the bits before it clear
+	static constexpr int is_canonical(const D128 x) {
+		if (is_nan(x)) {
+			const uint128 payload = (static_cast<uint128>(x.w[1] & 0x00003fffffffffffull) << 64) | x.w[0];
+			return (x.w[1] & 0x01ffc00000000000ull) == 0 && payload < coefficient_limit / 10;
+		}
+		if (is_inf(x)) {
+			return (x.w[1] & 0x03ffffffffffffffull) == 0 && x.w[0] == 0;
+		}
+		return (x.w[1] & steering_mask) != steering_mask && coefficient(x) < coefficient_limit;
+	}
+
+	static inline int quiet_equal(const D128 x, const D128 y, ErrorFlags * pfpsf) { return bid128_quiet_equal(x, y, pfpsf); }
+	static inline int quiet_less(const D128 x, const D128 y, ErrorFlags * pfpsf) { return bid128_quiet_less(x, y, pfpsf); }
+
+	static inline D128 round_integral_zero(const D128 x, ErrorFlags * pfpsf) { return bid128_round_integral_zero(x, pfpsf); }
+	static inline D128 quantize(const D128 x, const D128 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_quantize(x, y, rnd_mode, pfpsf); }
+	static inline D128 abs(const D128 x) { return bid128_abs(x); }
+	static inline D128 negate(const D128 x) { return bid128_negate(x); }
+	static inline D128 add(const D128 x, const D128 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { 
+		D128 z;
+		if (add_exact(x, y, rnd_mode, z)) {
+			return z;
+		}
+		return bid128_add(x, y, rnd_mode, pfpsf); 
+	}
+	static inline D128 sub(const D128 x, const D128 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { 
+		D128 z;
+		if (add_exact(x, D128{{y.w[0], y.w[1] ^ sign_mask}}, rnd_mode, z)) {
+			return z;
+		}
+		return bid128_sub(x, y, rnd_mode, pfpsf); 
+	}
+	static inline D128 mul(const D128 x, const D128 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { 
+		D128 z;
+		if (mul_exact(x, y, z)) {
+			return z;
+		}
+		return bid128_mul(x, y, rnd_mode, pfpsf); 
+	}
+	static inline D128 div(const D128 x, const D128 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_div(x, y, rnd_mode, pfpsf); }
+	static inline D128 fma(const D128 x, const D128 y, const D128 z, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_fma(x, y, z, rnd_mode, pfpsf); }
+};
+
+template <>
+struct bid_traits<D64> : bid_classification<D64, bid_traits<D64>> {
+	// format parameters: digits in the significand, 
+	// and the range of the exponent applied to the integral significand
+	static constexpr short precision = 16;
+	static constexpr short emax = 369;
+	static constexpr short emin = -398;
+
+	// encodes a coefficient below 10^16 and an exponent within [emin, emax]
+	static constexpr D64 encode(const bool negative, const unsigned __int128 c, const int exponent) { 
+		return bid64_engine::encode(negative, static_cast<uint64_t>(c), exponent - emin); 
+	}
+	// the coefficient and exponent of a finite value; a non-canonical coefficient reads as zero
+	static constexpr unsigned __int128 canonical_coefficient(const D64 x) { return bid64_engine::unpack(x).c; }
+	static constexpr int exponent(const D64 x) { return bid64_engine::unpack(x).e + emin; }
+
+	static constexpr D64 encode_inf(const bool negative) { return (negative? bid64_engine::sign_mask : 0) | bid64_engine::inf; }
+	static constexpr D64 encode_nan(const bool negative) { return (negative? bid64_engine::sign_mask : 0) | bid64_engine::nan; }
+	static constexpr D64 encode_snan(const bool negative) { return (negative? bid64_engine::sign_mask : 0) | bid64_engine::snan; }
+
+	static inline D64 from_string(char * ps, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_from_string(ps, rnd_mode, pfpsf); }
+	// every 32-bit integer fits, so these are always exact
+	static inline D64 from_uint32(const uint32_t x, const RoundMode, ErrorFlags *) { return bid64_from_uint32(x); }
+	static inline D64 from_int32(const int32_t x, const RoundMode, ErrorFlags *) { return bid64_from_int32(x); }
+	// a 64-bit integer may need up to 20 digits, so these can round
+	static inline D64 from_uint64(const uint64_t x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_from_uint64(x, rnd_mode, pfpsf); }
+	static inline D64 from_int64(const int64_t x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_from_int64(x, rnd_mode, pfpsf); }
+	static inline D64 from_binary32(const float x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return binary32_to_bid64(x, rnd_mode, pfpsf); }
+	static inline D64 from_binary64(const double x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return binary64_to_bid64(x, rnd_mode, pfpsf); }
+	// widening from a narrower format is always exact,
+	// narrowing from a wider one rounds and may overflow or underflow
+	static inline D64 from_bid(const D128 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_to_bid64(x, rnd_mode, pfpsf); }
+	static inline D64 from_bid(const D32 x, const RoundMode, ErrorFlags * pfpsf) { return bid32_to_bid64(x, pfpsf); }
+
+	static inline void to_string(char * ps, const D64 x, ErrorFlags * pfpsf) { bid64_to_string(ps, x, pfpsf); }
+	static inline uint8_t to_uint8_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_uint8_xrnint(x, pfpsf); }
+	static inline uint16_t to_uint16_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_uint16_xrnint(x, pfpsf); }
+	static inline uint32_t to_uint32_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_uint32_xrnint(x, pfpsf); }
+	static inline uint64_t to_uint64_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_uint64_xrnint(x, pfpsf); }
+	static inline int8_t to_int8_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_int8_xrnint(x, pfpsf); }
+	static inline int16_t to_int16_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_int16_xrnint(x, pfpsf); }
+	static inline int32_t to_int32_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_int32_xrnint(x, pfpsf); }
+	static inline int64_t to_int64_xrnint(const D64 x, ErrorFlags * pfpsf) { return bid64_to_int64_xrnint(x, pfpsf); }
+	static inline float to_binary32(const D64 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_to_binary32(x, rnd_mode, pfpsf); }
+	static inline double to_binary64(const D64 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_to_binary64(x, rnd_mode, pfpsf); }
+
+	// == classification == //
+	// masks on the bits; the rest comes from bid_classification
+	static constexpr int is_signed(const D64 x) { return bid64_engine::is_signed(x); }
+	static constexpr int is_inf(const D64 x) { return bid64_engine::is_inf(x); }
+	static constexpr int is_nan(const D64 x) { return bid64_engine::is_nan(x); }
+	static constexpr int is_snan(const D64 x) { return bid64_engine::is_snan(x); }
+
+	// canonical as for D128, with a coefficient below 10^16 and a NaN payload below 10^15
+	static constexpr int is_canonical(const D64 x) {
+		if (is_nan(x)) {
+			return (x & 0x01fc000000000000ull) == 0 && (x & 0x0003ffffffffffffull) < 1000000000000000ull;
+		}
+		if (is_inf(x)) {
+			return (x & 0x03ffffffffffffffull) == 0;
+		}
+		return (x & bid64_engine::steering_mask) != bid64_engine::steering_mask || 
+			((x & bid64_engine::large_coefficient_mask) | bid64_engine::large_coefficient_bits) < bid64_engine::coefficient_limit;
+	}
+
+	// arithmetic, comparison and rounding run on the native engine,
+	// so they inline and work in constant expressions
+	static constexpr int quiet_equal(const D64 x, const D64 y, ErrorFlags * pfpsf) { return bid64_engine::quiet_equal(x, y, pfpsf); }
+	static constexpr int quiet_less(const D64 x, const D64 y, ErrorFlags * pfpsf) { return bid64_engine::quiet_less(x, y, pfpsf); }
+	static constexpr int compare(const D64 x, const D64 y, ErrorFlags * pfpsf) { return bid64_engine::compare(x, y, pfpsf); }
+
+	static constexpr D64 round_integral_zero(const D64 x, ErrorFlags * pfpsf) { return bid64_engine::round_integral_zero(x, pfpsf); }
+	static constexpr D64 quantize(const D64 x, const D64 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_engine::quantize(x, y, rnd_mode, pfpsf); }
+	static constexpr D64 abs(const D64 x) { return bid64_engine::abs(x); }
+	static constexpr D64 negate(const D64 x) { return bid64_engine::negate(x); }
+	static constexpr D64 add(const D64 x, const D64 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_engine::add(x, y, rnd_mode, pfpsf); }
+	static constexpr D64 sub(const D64 x, const D64 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_engine::sub(x, y, rnd_mode, pfpsf); }
+	static constexpr D64 mul(const D64 x, const D64 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_engine::mul(x, y, rnd_mode, pfpsf); }
+	static constexpr D64 div(const D64 x, const D64 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_engine::div(x, y, rnd_mode, pfpsf); }
+	// the engine has no fused multiply-add
+	static inline D64 fma(const D64 x, const D64 y, const D64 z, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_fma(x, y, z, rnd_mode, pfpsf); }
+};
+
+template <>
+struct bid_traits<D32> : bid_classification<D32, bid_traits<D32>> {
+	// format parameters: digits in the significand, 
+	// and the range of the exponent applied to the integral significand
+	static constexpr short precision = 7;
+	static constexpr short emax = 90;
+	static constexpr short emin = -101;
+
+	// == encoding == //
+	// After the sign come either an 8-bit exponent and a 23-bit coefficient,
+	// or, when the next two bits are 11, an 8-bit exponent and the low 21 bits 
+	// of a coefficient whose implied high bits are 100.
+	static constexpr D32 sign_mask = 0x80000000u;
+
+	// encodes a coefficient below 10^7 and an exponent within [emin, emax]
+	static constexpr D32 encode(const bool negative, const unsigned __int128 c, const int exponent) {
+		const D32 sign = negative? sign_mask : 0;
+		const D32 e = static_cast<D32>(exponent - emin);
+		if (c < 0x800000u) {
+			return sign | (e << 23) | static_cast<D32>(c);
+		}
+		return sign | 0x60000000u | (e << 21) | (static_cast<D32>(c) & 0x1fffffu);
+	}
+	static constexpr D32 steering_mask = 0x60000000u;
+
+	// the coefficient and exponent of a finite value; a non-canonical coefficient reads as zero
+	static constexpr unsigned __int128 canonical_coefficient(const D32 x) {
+		const D32 c = ((x & steering_mask) == steering_mask)? ((x & 0x1fffffu) | 0x800000u) : (x & 0x7fffffu);
+		return (c < 10000000u)? c : 0;
+	}
+	static constexpr int exponent(const D32 x) {
+		return static_cast<int>(((x & steering_mask) == steering_mask)? ((x >> 21) & 0xff) : ((x >> 23) & 0xff)) + emin;
+	}
+
+	static constexpr D32 encode_inf(const bool negative) { return (negative? sign_mask : 0) | 0x78000000u; }
+	static constexpr D32 encode_nan(const bool negative) { return (negative? sign_mask : 0) | 0x7c000000u; }
+	static constexpr D32 encode_snan(const bool negative) { return (negative? sign_mask : 0) | 0x7e000000u; }
+
+	static inline D32 from_string(char * ps, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_from_string(ps, rnd_mode, pfpsf); }
+	// any integer may need more than 7 digits, so these can round
+	static inline D32 from_uint32(const uint32_t x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_from_uint32(x, rnd_mode, pfpsf); }
+	static inline D32 from_int32(const int32_t x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_from_int32(x, rnd_mode, pfpsf); }
+	static inline D32 from_uint64(const uint64_t x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_from_uint64(x, rnd_mode, pfpsf); }
+	static inline D32 from_int64(const int64_t x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_from_int64(x, rnd_mode, pfpsf); }
+	static inline D32 from_binary32(const float x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return binary32_to_bid32(x, rnd_mode, pfpsf); }
+	static inline D32 from_binary64(const double x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return binary64_to_bid32(x, rnd_mode, pfpsf); }
+	// narrowing from a wider format rounds and may overflow or underflow
+	static inline D32 from_bid(const D128 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid128_to_bid32(x, rnd_mode, pfpsf); }
+	static inline D32 from_bid(const D64 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid64_to_bid32(x, rnd_mode, pfpsf); }
+
+	static inline void to_string(char * ps, const D32 x, ErrorFlags * pfpsf) { bid32_to_string(ps, x, pfpsf); }
+	static inline uint8_t to_uint8_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_uint8_xrnint(x, pfpsf); }
+	static inline uint16_t to_uint16_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_uint16_xrnint(x, pfpsf); }
+	static inline uint32_t to_uint32_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_uint32_xrnint(x, pfpsf); }
+	static inline uint64_t to_uint64_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_uint64_xrnint(x, pfpsf); }
+	static inline int8_t to_int8_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_int8_xrnint(x, pfpsf); }
+	static inline int16_t to_int16_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_int16_xrnint(x, pfpsf); }
+	static inline int32_t to_int32_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_int32_xrnint(x, pfpsf); }
+	static inline int64_t to_int64_xrnint(const D32 x, ErrorFlags * pfpsf) { return bid32_to_int64_xrnint(x, pfpsf); }
+	static inline float to_binary32(const D32 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_to_binary32(x, rnd_mode, pfpsf); }
+	static inline double to_binary64(const D32 x, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_to_binary64(x, rnd_mode, pfpsf); }
+
+	// == classification == //
+	// masks on the bits; the rest comes from bid_classification
+	static constexpr int is_signed(const D32 x) { return (x & sign_mask) != 0; }
+	static constexpr int is_inf(const D32 x) { return (x & 0x7c000000u) == 0x78000000u; }
+	static constexpr int is_nan(const D32 x) { return (x & 0x7c000000u) == 0x7c000000u; }
+	static constexpr int is_snan(const D32 x) { return (x & 0x7e000000u) == 0x7e000000u; }
+
+	// canonical as for D128, with a coefficient below 10^7 and a NaN payload below 10^6
+	static constexpr int is_canonical(const D32 x) {
+		if (is_nan(x)) {
+			return (x & 0x01f00000u) == 0 && (x & 0x000fffffu) < 1000000u;
+		}
+		if (is_inf(x)) {
+			return (x & 0x03ffffffu) == 0;
+		}
+		return (x & steering_mask) != steering_mask || ((x & 0x1fffffu) | 0x800000u) < 10000000u;
+	}
+
+	static inline int quiet_equal(const D32 x, const D32 y, ErrorFlags * pfpsf) { return bid32_quiet_equal(x, y, pfpsf); }
+	static inline int quiet_less(const D32 x, const D32 y, ErrorFlags * pfpsf) { return bid32_quiet_less(x, y, pfpsf); }
+
+	static inline D32 round_integral_zero(const D32 x, ErrorFlags * pfpsf) { return bid32_round_integral_zero(x, pfpsf); }
+	static inline D32 quantize(const D32 x, const D32 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_quantize(x, y, rnd_mode, pfpsf); }
+	static inline D32 abs(const D32 x) { return bid32_abs(x); }
+	static inline D32 negate(const D32 x) { return bid32_negate(x); }
+	static inline D32 add(const D32 x, const D32 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_add(x, y, rnd_mode, pfpsf); }
+	static inline D32 sub(const D32 x, const D32 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_sub(x, y, rnd_mode, pfpsf); }
+	static inline D32 mul(const D32 x, const D32 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_mul(x, y, rnd_mode, pfpsf); }
+	static inline D32 div(const D32 x, const D32 y, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_div(x, y, rnd_mode, pfpsf); }
+	static inline D32 fma(const D32 x, const D32 y, const D32 z, const RoundMode rnd_mode, ErrorFlags * pfpsf) { return bid32_fma(x, y, z, rnd_mode, pfpsf); }
+};
+
+// Rounds (-1)^negative * c * 10^exponent, for any c and exponent, to the nearest value of T,
+// raising overflow, underflow and inexact as libbid does.
+// sticky means that something non-zero but less than half a unit of the last digit of c 
+// was already dropped (and c has more digits than T keeps).
+template <class T>
+constexpr T bid_round(const bool negative, unsigned __int128 c, int exponent, const bool sticky, 
+					  const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+	typedef bid_traits<T> bid;
+	constexpr ErrorFlags overflow = 0x08; // IDecimal::Error::Overflow
+	constexpr ErrorFlags underflow = 0x10; // IDecimal::Error::Underflow
+	constexpr ErrorFlags inexact = 0x20; // IDecimal::Error::Inexact
+
+	int n = decimal_digits(c) - bid::precision;
+	if (n < 0) {
+		n = 0;
+	}
+
+	// below the smallest exponent the result is subnormal, so more digits go
+	const bool tiny = (exponent + n < bid::emin);
+	if (tiny) {
+		n = bid::emin - exponent;
+	}
+
+	if (n > 0) {
+		ErrorFlags flags = 0;
+		c = shift_digits(c, n, sticky, negative, rnd_mode, flags);
+		exponent += n;
+		if (c == pow10_128[bid::precision]) {
+			// rounding carried into an extra digit
+			c /= 10;
+			++exponent;
+		}
+		if (flags != 0) {
+			*pfpsf |= tiny? (flags | underflow) : flags;
+		}
+	}
+
+	if (c == 0) {
+		exponent = (exponent < bid::emin)? bid::emin : (exponent > bid::emax)? bid::emax : exponent;
+	} else if (exponent > bid::emax) {
+		if (decimal_digits(c) + (exponent - bid::emax) <= bid::precision) {
+			// an exact result with too large an exponent fits with trailing zeros
+			c *= pow10_128[exponent - bid::emax];
+			exponent = bid::emax;
+		} else {
+			*pfpsf |= overflow | inexact;
+			const bool to_inf = (rnd_mode == 0) || (rnd_mode == 4) || // NearestEven, NearestAway
+				(rnd_mode == 2 && !negative) || (rnd_mode == 1 && negative); // Upward, Downward
+			return to_inf? bid::encode_inf(negative) : bid::encode(negative, pow10_128[bid::precision] - 1, bid::emax);
+		}
+	}
+	return bid::encode(negative, c, exponent);
+}
+
+// A hash that depends only on the value, so values that compare equal hash alike:
+// the members of a cohort (1.0 and 1.00), zeros of either sign and any exponent,
+// and the same value held in different widths. NaNs, which equal nothing, all hash alike.
+// The cohort is normalized by stripping trailing zeros from the coefficient,
+// then the sign, coefficient and exponent are mixed.
+template <class T>
+constexpr uint64_t bid_hash(const T x) {
+	typedef bid_traits<T> bid;
+
+	// the finalizer of MurmurHash3
+	constexpr auto mix = [](uint64_t h) {
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	};
+
+	if (bid::is_nan(x)) {
+		return mix(0x7c);
+	}
+	if (bid::is_inf(x)) {
+		return mix(bid::is_signed(x)? 0xf8 : 0x78);
+	}
+
+	unsigned __int128 c = bid::canonical_coefficient(x);
+	if (c == 0) {
+		return mix(0);
+	}
+
+	int exponent = bid::exponent(x);
+	if ((c >> 64) != 0) {
+		while (c % 10000000000000000ull == 0) {
+			c /= 10000000000000000ull;
+			exponent += 16;
+		}
+	}
+	if ((c >> 64) == 0) {
+		// most coefficients fit in 64 bits, where division is much cheaper
+		uint64_t c64 = static_cast<uint64_t>(c);
+		while (c64 % 10000 == 0) {
+			c64 /= 10000;
+			exponent += 4;
+		}
+		while (c64 % 10 == 0) {
+			c64 /= 10;
+			++exponent;
+		}
+		c = c64;
+	} else {
+		while (c % 10 == 0) {
+			c /= 10;
+			++exponent;
+		}
+	}
+
+	const uint64_t header = (static_cast<uint64_t>(static_cast<uint32_t>(exponent)) << 1) | (bid::is_signed(x)? 1 : 0);
+	return mix(static_cast<uint64_t>(c) ^ mix(static_cast<uint64_t>(c >> 64) ^ mix(header)));
+}
+
+// Encodes values of T as fixed-width byte strings whose lexicographic order 
+// (memcmp, or radix sort on the bytes) is the total order of IEEE 754:
+//	 -NaN < -Inf < negative numbers < -0 < +0 < positive numbers < +Inf < +NaN,
+// where the members of a cohort (1.0 and 1.00) are ordered by exponent,
+// and signaling NaNs lie between the infinities and quiet NaNs, ordered by payload.
+// Decoding gives back the bits of any canonical value;
+// non-canonical encodings come back canonical.
+//
+// The key holds, most significant first: the sign, the kind of value 
+// (zero, finite, infinite or NaN), the adjusted exponent (that of the leading digit),
+// the coefficient scaled to full precision, and where the exponent lies in its cohort.
+// All bits after the sign are inverted for negative values, reversing their order.
+// Keys are 17, 9 and 5 bytes long for D128, D64 and D32.
+template <class T>
+struct order_key {
+	typedef bid_traits<T> bid;
+	typedef unsigned __int128 uint128;
+
+	static constexpr int bit_width(uint128 x) { 
+		int n = 0; 
+		for (; x != 0; x >>= 1) { 
+			++n; 
+		} 
+		return n; 
+	}
+
+	// field widths
+	static constexpr int min_adjusted = bid::emin;
+	static constexpr int max_adjusted = bid::emax + bid::precision - 1;
+	static constexpr int exponent_bits = bit_width(max_adjusted - min_adjusted);
+	static constexpr int coefficient_bits = bit_width(pow10_128[bid::precision] - 1);
+	static constexpr int cohort_bits = bit_width(bid::precision - 1);
+	static constexpr int bits = 3 + exponent_bits + coefficient_bits + cohort_bits;
+	static constexpr size_t size = (bits + 7) / 8;
+	static constexpr int padding = static_cast<int>(size) * 8 - bits;
+
+	typedef std::array<uint8_t, size> bytes;
+
+	// kinds of values, in order
+	static constexpr uint128 zero = 0;
+	static constexpr uint128 finite = 1;
+	static constexpr uint128 infinite = 2;
+	static constexpr uint128 nan = 3;
+
+	// the key is built as a 256-bit integer in (hi, lo)
+	static constexpr void push(uint128 & hi, uint128 & lo, const uint128 value, const int n) {
+		hi = (hi << n) | (lo >> (128 - n));
+		lo = (lo << n) | value;
+	}
+
+	static constexpr uint128 pop(uint128 & hi, uint128 & lo, const int n) {
+		const uint128 value = lo & ((static_cast<uint128>(1) << n) - 1);
+		lo = (lo >> n) | (hi << (128 - n));
+		hi >>= n;
+		return value;
+	}
+
+	static constexpr bytes encode(const T x) {
+		const bool negative = bid::is_signed(x);
+		uint128 kind = finite;
+		uint128 exponent = 0;
+		uint128 coefficient = 0;
+		uint128 cohort = 0;
+		if (bid::is_nan(x)) {
+			// a payload that is not canonical reads as zero
+			kind = nan;
+			exponent = bid::is_snan(x)? 0 : 1;
+			coefficient = bid::is_canonical(x)? nan_payload(x) : 0;
+		} else if (bid::is_inf(x)) {
+			kind = infinite;
+		} else {
+			const uint128 c = bid::canonical_coefficient(x);
+			const int e = bid::exponent(x);
+			if (c == 0) {
+				kind = zero;
+				exponent = static_cast<uint128>(e - min_adjusted);
+			} else {
+				const int digits = decimal_digits(c);
+				exponent = static_cast<uint128>(e + digits - 1 - min_adjusted);
+				coefficient = c * pow10_128[bid::precision - digits];
+				cohort = static_cast<uint128>(bid::precision - digits);
+			}
+		}
+
+		uint128 hi = 0, lo = 0;
+		push(hi, lo, 1, 1);
+		push(hi, lo, kind, 2);
+		push(hi, lo, exponent, exponent_bits);
+		push(hi, lo, coefficient, coefficient_bits);
+		push(hi, lo, cohort, cohort_bits);
+		if (padding > 0) {
+			push(hi, lo, 0, padding);
+		}
+
+		bytes key = {};
+		for (size_t i = 0; i < size; ++i) {
+			const int shift = static_cast<int>(size - 1 - i) * 8;
+			const uint8_t byte = static_cast<uint8_t>((shift >= 128)? (hi >> (shift - 128)) : (lo >> shift));
+			key[i] = negative? static_cast<uint8_t>(~byte) : byte;
+		}
+		return key;
+	}
+
+	static constexpr T decode(const bytes & key) {
+		const bool negative = (key[0] & 0x80) == 0;
+		uint128 hi = 0, lo = 0;
+		for (size_t i = 0; i < size; ++i) {
+			push(hi, lo, negative? static_cast<uint8_t>(~key[i]) : key[i], 8);
+		}
+		if (padding > 0) {
+			pop(hi, lo, padding);
+		}
+
+		const uint128 cohort = pop(hi, lo, cohort_bits);
+		const uint128 coefficient = pop(hi, lo, coefficient_bits);
+		const int exponent = static_cast<int>(pop(hi, lo, exponent_bits));
+		const uint128 kind = pop(hi, lo, 2);
+		if (kind == zero) {
+			return bid::encode(negative, 0, exponent + min_adjusted);
+		} else if (kind == infinite) {
+			return bid::encode_inf(negative);
+		} else if (kind == nan) {
+			return with_payload(exponent? bid::encode_nan(negative) : bid::encode_snan(negative), coefficient);
+		}
+		const int digits = bid::precision - static_cast<int>(cohort);
+		return bid::encode(negative, coefficient / pow10_128[bid::precision - digits], exponent + min_adjusted - digits + 1);
+	}
+
+	// converts a column of values into keys, and back
+	static void encode(const std::span<const T> values, const std::span<bytes> keys) {
+		assert(keys.size() >= values.size());
+		for (size_t i = 0; i < values.size(); ++i) {
+			keys[i] = encode(values[i]);
+		}
+	}
+
+	static void decode(const std::span<const bytes> keys, const std::span<T> values) {
+		assert(values.size() >= keys.size());
+		for (size_t i = 0; i < keys.size(); ++i) {
+			values[i] = decode(keys[i]);
+		}
+	}
+
+private:
+	// a NaN's payload sits in the low bits of its coefficient field
+	static constexpr uint128 nan_payload(const T x) {
+		if constexpr (std::is_same_v<T, D128>) {
+			return (static_cast<uint128>(x.w[1] & 0x00003fffffffffffull) << 64) | x.w[0];
+		} else if constexpr (std::is_same_v<T, D64>) {
+			return x & 0x0003ffffffffffffull;
+		} else {
+			return x & 0x000fffffu;
+		}
+	}
+
+	static constexpr T with_payload(T x, const uint128 payload) {
+		if constexpr (std::is_same_v<T, D128>) {
+			x.w[0] = static_cast<uint64_t>(payload);
+			x.w[1] |= static_cast<uint64_t>(payload >> 64);
+			return x;
+		} else {
+			return x | static_cast<T>(payload);
+		}
+	}
+};
+
+class IDecimal {
+public:
+	// rounding modes
+	// NearestEven apparently means half-even
+	enum Round: unsigned int{
+		NearestEven = 0,	// 3.1415 -> 3.142,		2.71828182845 -> 2.7182818284
+		Downward    = 1,	// -3.1415 -> -3.142	3.1415 -> 3.141
+		Upward      = 2,	// -3.1415 -> 3.141     3.1415 -> 3.142
+		TowardZero  = 3,	// -3.1415 -> -3.141	3.1415 -> 3.141
+		NearestAway = 4		// 3.1415 -> 3.142,		2.71828182845 -> 2.7182818285
+	};
+	
+	// classes of values, numbered as in libbid
+	enum Class: unsigned int {
+		SignalingNaN		= 0,
+		QuietNaN			= 1,
+		NegativeInfinity	= 2,
+		NegativeNormal		= 3,
+		NegativeSubnormal	= 4,
+		NegativeZero		= 5,
+		PositiveZero		= 6,
+		PositiveSubnormal	= 7,
+		PositiveNormal		= 8,
+		PositiveInfinity	= 9
+	};
+
+	enum Error: unsigned int {
+		None			= 0x00,
+		Invalid			= 0x01,
+		DivideByZero	= 0x04,
+		Overflow		= 0x08,
+		Underflow		= 0x10,
+		Inexact			= 0x20,
+		Undefined		= Error::Invalid | Error::DivideByZero | Error::Overflow | Error::Underflow,
+		Any				= 0xFF
+	};
+	
+	struct Exception : public std::runtime_error {
+		const ErrorFlags flags;
+		const IDecimal * decimal;
+
+		Exception(const std::string & message, ErrorFlags flags = Error::None, const IDecimal * decimal = nullptr) 
+			: std::runtime_error(message), flags(flags), decimal(decimal) {}
+		Exception(const char * message, ErrorFlags flags = Error::None, const IDecimal * decimal = nullptr) 
+			: Exception(std::string(message), flags, decimal) {}
+	};
+	
+	struct InvalidException : public Exception { using Exception::Exception; };
+	struct DivideByZeroException : public Exception { using Exception::Exception; };
+	struct OverflowException : public Exception { using Exception::Exception; };
+	struct UnderflowException : public Exception { using Exception::Exception; };
+	struct InexactException : public Exception { using Exception::Exception; };
+	struct NonDecimalException: public std::runtime_error {
+		const std::string value; 
+		NonDecimalException(const char value) :
+			std::runtime_error("Non-decimal value received"), value(std::string(1, value)) {}
+		NonDecimalException(const char * value) :
+			std::runtime_error("Non-decimal value received"), value(value) {}
+		NonDecimalException(const std::string & value) :
+			std::runtime_error("Non-decimal value received"), value(value) {}
+	};
+
+	// The rounding mode, the errors raised so far (sticky until cleared) 
+	// and the errors that throw (the traps).
+	// These are kept here rather than in each decimal,
+	// so that a decimal holds nothing but its value.
+	struct Context {
+		RoundMode round_mode = Round::NearestEven;
+		ErrorFlags errors = Error::None;
+		ErrorFlags throw_on_err = Error::Undefined;
+
+		void throw_on(const Error & error) { this->throw_on_err |= error; }
+		void throw_off(const Error & error) { this->throw_on_err &= ~error; }
+		void clear() { this->errors = Error::None; }
+
+		bool divide_by_zero() const { return ((this->errors & Error::DivideByZero) == Error::DivideByZero); }
+		bool overflow() const { return ((this->errors & Error::Overflow)== Error::Overflow); }
+		bool underflow() const { return ((this->errors & Error::Underflow) == Error::Underflow); }
+		bool inexact() const { return ((this->errors & Error::Inexact) == Error::Inexact); }
+	};
+
+	// the context of all decimal operations on the calling thread;
+	// each thread starts with a default context
+	static Context & context() {
+		static thread_local Context c;
+		return c;
+	}
+
+	// Replaces the context of the calling thread until it goes out of scope,
+	// then restores the previous one, including its errors.
+	// Without an argument it starts from a copy of the current context.
+	class LocalContext {
+		const Context saved;
+
+	public:
+		LocalContext() : saved(IDecimal::context()) {}
+		explicit LocalContext(const Context & c) : saved(IDecimal::context()) { IDecimal::context() = c; }
+		~LocalContext() { IDecimal::context() = this->saved; }
+
+		LocalContext(const LocalContext &) = delete;
+		LocalContext & operator=(const LocalContext &) = delete;
+
+		Context & operator*() const { return IDecimal::context(); }
+		Context * operator->() const { return &IDecimal::context(); }
+	};
+};
+
+// A policy decides the rounding mode of an operation,
+// the errors that throw and what happens to the errors raised.
+
+// Takes everything from the calling thread's context.
+struct ContextPolicy {
+	// used by constructors when no arguments are given
+	static RoundMode default_round_mode() { return IDecimal::context().round_mode; }
+	static ErrorFlags default_traps() { return IDecimal::context().throw_on_err; }
+
+	IDecimal::Context & context;
+
+	ContextPolicy() : context(IDecimal::context()) {}
+
+	RoundMode round_mode() const { return this->context.round_mode; }
+	ErrorFlags traps() const { return this->context.throw_on_err; }
+	void save(const ErrorFlags flags) const { this->context.errors |= flags; }
+};
+
+// Fixes the rounding mode and the errors that throw at compile time,
+// and never touches the context, so errors that do not throw are dropped.
+template <RoundMode R, ErrorFlags Traps>
+struct StaticPolicy {
+	static_assert((Traps & IDecimal::Error::Invalid) == IDecimal::Error::Invalid, "Error::Invalid is required for all operations.");
+
+	static constexpr RoundMode default_round_mode() { return R; }
+	static constexpr ErrorFlags default_traps() { return Traps; }
+
+	static constexpr RoundMode round_mode() { return R; }
+	static constexpr ErrorFlags traps() { return Traps; }
+	static constexpr void save(const ErrorFlags) {}
+};
+
+// a finite decimal as its parts: (-1)^negative * coefficient * 10^exponent
+struct Decomposed {
+	bool negative;
+	unsigned __int128 coefficient;
+	int exponent;
+
+	friend constexpr bool operator==(const Decomposed &, const Decomposed &) = default;
+};
+
+// Base class for decimal types
+// T is the storage type and D is the derived decimal type.
+// D::policy supplies the rounding mode and the errors that throw.
+// Operations are dispatched statically through bid_traits<T>,
+// and the base holds nothing but the value, 
+// so a decimal is exactly as large as its storage type.
+template <class T, class D>
+class DecimalBase : public IDecimal {
+protected:
+	// decimals of other widths read each other's values when converting
+	template <class U, class E> friend class DecimalBase;
+	// accumulators round their sums under the policy of D
+	template <class E> friend class DecimalAccumulator;
+
+	typedef bid_traits<T> bid;
+
+	// derived types may replace this with a StaticPolicy
+	typedef ContextPolicy policy;
+
+	T _val;
+
+	// the rounding mode and the errors that throw under the policy of D
+	static inline RoundMode rounding() { return typename D::policy().round_mode(); }
+	static inline ErrorFlags traps() { return typename D::policy().traps(); }
+	
+	// throws an exception if an invalid operation occurred	
+	static void check_flags(const ErrorFlags flags, const ErrorFlags throw_on_err = Error::Undefined) { 
+		if ((flags & Error::Invalid) == Error::Invalid) {
+			throw IDecimal::InvalidException("Invalid decimal operation", flags, nullptr);
+		} else if ((flags & throw_on_err & Error::DivideByZero) == Error::DivideByZero) {
+			throw IDecimal::DivideByZeroException("Attempt to divide by zero", flags, nullptr);
+		} else if ((flags & throw_on_err & Error::Overflow) == Error::Overflow) {
+			throw IDecimal::OverflowException("Overflow", flags, nullptr);
+		} else if ((flags & throw_on_err & Error::Underflow) == Error::Underflow) {
+			throw IDecimal::UnderflowException("Underflow", flags, nullptr);
+		} else if ((flags & throw_on_err & Error::Inexact) == Error::Inexact) {
+			throw IDecimal::InexactException("Inexact", flags, nullptr);
+		}
+	}
+
+	// saves the flags under the policy so they can be read later,
+	// and checks them for invalid operations
+	template <class P>
+	static inline void save_flags(const P & policy, const ErrorFlags flags) {
+		save_flags(policy, flags, policy.traps());
+	}
+
+	// as above, but with the errors that throw given by the caller
+	template <class P>
+	static inline void save_flags(const P & policy, const ErrorFlags flags, const ErrorFlags throw_on_err) {
+		if (flags != Error::None) {
+			policy.save(flags);
+			check_flags(flags, throw_on_err);
+		}
+	}
+
+	// helper method to convert a value to the storage type,
+	// saving the flags under the policy of D
+	template <class F>
+	static T convert(F func, const ErrorFlags throw_on_err) {
+		ErrorFlags flags = Error::None;
+		const T result = func(&flags);
+		save_flags(typename D::policy(), flags, throw_on_err);
+		return result;
+	}
+
+	// helper method to invoke an operation
+	// this method does not save any flags
+	// (it does not modify the object)	
+	template <class F>
+	static void invoke(F func, const ErrorFlags throw_on_err = Error::Undefined) {
+		ErrorFlags flags = Error::None;
+		func(&flags);
+		check_flags(flags, throw_on_err);
+	}
+
+	// helper method to invoke an operation
+	// this method does not save any flags
+	// (it does not modify the object)	
+	// this method returns the result of the operation
+	template <class TResult, class F>
+	static TResult invoke(F func, const ErrorFlags throw_on_err = Error::Undefined) {
+		ErrorFlags flags = Error::None;
+		TResult result = func(&flags);
+		check_flags(flags, throw_on_err);
+		return result;
+	}
+	
+	// encapsulates construction / destruction of a char*
+	struct cstr {
+		char* val;
+		cstr(std::string & s) {
+			this->val = new char[s.length() + 1];
+			strcpy(this->val, s.c_str());
+		}
+		cstr(const char * c) {
+			this->val = new char[strlen(c) + 1];
+			strcpy(this->val, c);
+		}
+		~cstr() {
+			delete[] this->val;
+		}
+	};
+		
+	// 10^n, usable in constant expressions
+	static constexpr uint64_t pow10(const unsigned n) {
+		return (n == 0)? 1 : 10 * pow10(n - 1);
+	}
+
+	static const std::string random_str() {
+		constexpr auto precision = bid::precision;
+		constexpr auto emin = bid::emin;
+		constexpr auto emax = bid::emax;
+
+
+		// Algorithm derived from IEEE754-2008, Page 8
+		// Signed zero and non-zero floating-point numbers of the form (−1)^s*b^q*c, where
+		// 	s is 0 or 1.
+		// 	q is any integer emin <= q + p − 1 <= emax.
+		// 	c is a number represented by a digit string of the form
+		//	d0 d1 d2 ... dp−1 where di is an integer digit 0 <= di < b (c is therefore an integer with 0 <= c < b^p).
+
+		// setup a random number generator,
+		// make it static so we don't have to rebuild it with every call
+ 		static std::random_device rd;
+    	static std::mt19937_64 gen(rd());
+
+		// use a bernoulli probability distribution to decide whether the number will be negative
+		static auto sign_dist = std::bernoulli_distribution(0.5);
+
+		// use a uniform integer distribution to generate the digits of the significand
+		// create two 64-bit integers, and use modulus to extract the first p / 2 bits of each
+		static auto significand_dist = std::uniform_int_distribution<uint64_t>(0, std::numeric_limits<uint64_t>::max());
+		static constexpr uint64_t mask = pow10(precision >> 1);
+		
+		// use a uniform integer distribution to generate the exponent in the range [emin - p + 1, emax - p + 1]
+		static auto exponent_dist = std::uniform_int_distribution<short>(emin, emax);
+	
+		// generate the random parameters	
+		bool negative = sign_dist(gen);
+		uint64_t significand_low = significand_dist(gen) % mask;
+		uint64_t significand_high = significand_dist(gen) % mask;
+		short exponent = exponent_dist(gen);
+
+		// create a string with the following format:
+		// "sDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDDE+DDDD" + \0
+		constexpr auto n = precision + 8;
+		char result[n];
+		sprintf(result, "%c%llu%lluE%+d", (negative? '-' : '+'), static_cast<unsigned long long>(significand_high), static_cast<unsigned long long>(significand_low), exponent);
+		return result;
+	}
+
+	// conversions to the storage type, shared by the constructors
+	static const T from_string(const std::string & value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		auto c = cstr( (value.empty()? "0" : value.c_str()) );
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_string(c.val, round_mode, flags);
+		}, throw_on_err);
+	}
+	
+	static const T from_cstring(const char * value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		auto val = (strcmp(value, "") == 0)? "0" : value;
+		auto c = cstr(val);
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_string(c.val, round_mode, flags);
+		}, throw_on_err);
+	}
+	
+	static const T from_uint32(const unsigned int value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_uint32(value, round_mode, flags);
+		}, throw_on_err);
+	}
+
+	static const T from_int32(const int value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_int32(value, round_mode, flags);
+		}, throw_on_err);
+	}
+
+	static const T from_uint64(const unsigned long long value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_uint64(value, round_mode, flags);
+		}, throw_on_err);
+	}
+
+	static const T from_int64(const long long value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_int64(value, round_mode, flags);
+		}, throw_on_err);
+	}
+	
+	static const T from_float(const float value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_binary32(value, round_mode, flags);
+		}, throw_on_err);
+	}
+
+	static const T from_double(const double value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
+		return DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_binary64(value, round_mode, flags);
+		}, throw_on_err);
+	}
+
+	// selects the constructor that takes the encoded value as is,
+	// which would otherwise be ambiguous when T is an integer (D64)
+	struct bits_tag {};
+
+	// All constructors must eventually invoke this constructor	
+	constexpr DecimalBase(const bits_tag, 
+				const T value, 
+				const ErrorFlags throw_on_err = Error::Undefined)  
+		: _val(value) {
+			if ((throw_on_err & Error::Invalid) != Error::Invalid) {
+				throw Exception("Error::Invalid is required for all operations.");
+			}
+		}
+
+	// wraps an encoded value in the derived type
+	static constexpr const D make(const T value) noexcept {
+		return D(bits_tag(), value);
+	}
+	
+	// runs op(round_mode, flags) under the policy of D, then saves and checks the flags
+	template <class F>
+	static inline const D with_policy(F op) {
+		const typename D::policy policy;
+		ErrorFlags flags = Error::None;
+		auto val = op(policy.round_mode(), &flags);
+		save_flags(policy, flags);
+		return make(val);
+	}
+
+	// the operation is a template parameter,
+	// so it is called directly rather than through a pointer
+	template <T (*op)(const T, const T, const RoundMode, ErrorFlags *)>
+	static inline const D binary_op(const DecimalBase & l, const DecimalBase & r) {
+		// the policy (e.g. the thread's context) is looked up once per operation
+		const typename D::policy policy;
+		ErrorFlags flags = Error::None;
+		auto val = op(l._val, r._val, policy.round_mode(), &flags);
+		save_flags(policy, flags);
+		return make(val);
+	}
+	
+public:	 	
+	DecimalBase() : DecimalBase(static_cast<int>(0)) {}
+
+	DecimalBase(const unsigned int value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::from_uint32(value, round_mode, throw_on_err), throw_on_err) {}
+	
+	DecimalBase(const unsigned long long value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::from_uint64(value, round_mode, throw_on_err), throw_on_err) {}
+
+	DecimalBase(const int value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::from_int32(value, round_mode, throw_on_err), throw_on_err) {}
+
+	DecimalBase(const long long value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::from_int64(value, round_mode, throw_on_err), throw_on_err) {}			
+
+	DecimalBase(const std::string & value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::from_string(value, round_mode, throw_on_err), throw_on_err) {}
+
+	DecimalBase(const char * value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps())
+		: DecimalBase(bits_tag(), DecimalBase::from_cstring(value, round_mode, throw_on_err), throw_on_err) {}
+
+	DecimalBase(const unsigned char value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(static_cast<unsigned int>(value), round_mode, throw_on_err) {}
+
+	DecimalBase(const unsigned short value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(static_cast<unsigned int>(value), round_mode, throw_on_err) {}
+
+	DecimalBase(const unsigned long value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(static_cast<unsigned long long>(value), round_mode, throw_on_err) {}
+	
+	DecimalBase(const char value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(static_cast<int>(value), round_mode, throw_on_err) {}
+
+	DecimalBase(const short value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(static_cast<int>(value), round_mode, throw_on_err) {}
+
+	DecimalBase(const long value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(static_cast<long long>(value), round_mode, throw_on_err) {}
+
+	DecimalBase(const float value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::from_float(value, round_mode, throw_on_err), throw_on_err) {}
+	
+	DecimalBase(const double value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::from_double(value, round_mode, throw_on_err), throw_on_err) {}
+
+	// widens a narrower decimal, which is always exact
+	template <class U, class E, typename std::enable_if<(bid_traits<U>::precision < bid_traits<T>::precision), int>::type = 0>
+	DecimalBase(const DecimalBase<U, E> & value)
+		: DecimalBase(bits_tag(), DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_bid(value._val, Round::NearestEven, flags);
+		}, DecimalBase::traps())) {}
+
+	// converts a decimal of the same width but another policy, which is always exact
+	template <class E, typename std::enable_if<!std::is_same<D, E>::value, int>::type = 0>
+	explicit DecimalBase(const DecimalBase<T, E> & value)
+		: DecimalBase(bits_tag(), value._val) {}
+
+	// narrows a wider decimal, rounding with the given mode
+	template <class U, class E, typename std::enable_if<(bid_traits<U>::precision > bid_traits<T>::precision), int>::type = 0>
+	explicit DecimalBase(const DecimalBase<U, E> & value, 
+				const RoundMode round_mode = D::policy::default_round_mode(), 
+				const ErrorFlags throw_on_err = D::policy::default_traps()) 
+		: DecimalBase(bits_tag(), DecimalBase::convert([&](ErrorFlags * flags) {
+			return bid::from_bid(value._val, round_mode, flags);
+		}, throw_on_err), throw_on_err) {}
+
+
+	// combines the given error flags to produce a comma-separated list
+	static const std::string error_str(const unsigned int flags) {
+		std::stringstream ss;
+		std::vector<std::string> v;
+
+		if ((flags & Error::Invalid) == Error::Invalid) {
+			v.push_back("invalid");
+		} else if ((flags & Error::DivideByZero) == DivideByZero) {
+			v.push_back("zerodivide");
+		} else if ((flags & Error::Overflow) == Error::Overflow) {
+			v.push_back("overflow");
+		} else if ((flags & Error::Underflow) == Error::Underflow) {
+			v.push_back("underflow");
+		} else if ((flags & Error::Inexact) == Error::Inexact) {
+			v.push_back("inexact");
+		}
+
+		if (v.size() > 0) {
+			for(size_t i = 0; i < v.size(); ++i) {
+				if (i != 0)
+					ss << ", ";
+				ss << v[i];
+			}
+		} else {
+			ss << "None";
+		}
+			
+		return ss.str();
+	}
+	
+	// converts the decimal to a string
+	const std::string str() {
+		static_assert(bid::precision > 0, "precision must be positive");
+		constexpr auto len = bid::precision + 8; // 6 for the exponent, 1 for the sign, 1 for \0
+		char buf[len];
+		this->invoke([&](ErrorFlags * flags) {
+			bid::to_string (buf, this->_val, flags);
+		}, DecimalBase::traps());	
+			
+		buf[len - 1] = '\0'; // in case to_string fails to add one
+		return buf;
+	}
+	
+	// scientific notation with one digit before the point, e.g. -1.2300E+5,
+	// keeping every digit of the coefficient; zero is always 0E+0
+	const std::string sci() const {
+		if (!bid::is_finite(this->_val)) {
+			return std::string(bid::is_signed(this->_val)? "-" : "+") + 
+				(bid::is_nan(this->_val)? (bid::is_snan(this->_val)? "SNaN" : "NaN") : "Inf");
+		}
+
+		const Decomposed parts = this->decompose();
+		if (parts.coefficient == 0) {
+			return "0E+0";
+		}
+
+		// the digits of the coefficient, least significant first
+		char digits[40];
+		int n = 0;
+		for (auto c = parts.coefficient; c != 0; c /= 10) {
+			digits[n++] = static_cast<char>('0' + static_cast<int>(c % 10));
+		}
+
+		std::string result = parts.negative? "-" : "";
+		result += digits[n - 1];
+		if (n > 1) {
+			result += '.';
+			for (int i = n - 2; i >= 0; --i) {
+				result += digits[i];
+			}
+		}
+		const int exponent = parts.exponent + n - 1;
+		result += (exponent < 0)? "E-" : "E+";
+		result += std::to_string((exponent < 0)? -exponent : exponent);
+		return result;
+	}
+	
+	// == classification == //
+	// computed inline from the bits, without calling libbid
+	constexpr bool is_negative() const noexcept {
+		return (bid::is_signed(this->_val) > 0);
+	}
+
+	constexpr bool is_signed() const noexcept {
+		return (bid::is_signed(this->_val) > 0);
+	}
+	
+	constexpr bool is_normal() const noexcept {
+		return (bid::is_normal(this->_val) > 0);
+	}
+
+	constexpr bool is_subnormal() const noexcept {
+		return (bid::is_subnormal(this->_val) > 0);
+	}
+	
+	constexpr bool is_zero() const noexcept {
+		return (bid::is_zero(this->_val) > 0);
+	}
+
+	constexpr bool is_finite() const noexcept {
+		return (bid::is_finite(this->_val) > 0);
+	}
+
+	constexpr bool is_inf() const noexcept {
+		return (bid::is_inf(this->_val) > 0);
+	}
+
+	constexpr bool is_nan() const noexcept {
+		return (bid::is_nan(this->_val) > 0);
+	}
+
+	constexpr bool is_signaling() const noexcept {
+		return (bid::is_snan(this->_val) > 0);
+	}
+
+	// whether the value is encoded the way libbid encodes its results
+	constexpr bool is_canonical() const noexcept {
+		return (bid::is_canonical(this->_val) > 0);
+	}
+
+	constexpr IDecimal::Class classify() const noexcept {
+		return static_cast<IDecimal::Class>(bid::classify(this->_val));
+	}
+	
+	// == operators to convert to native types == //
+	explicit operator unsigned char() const { 
+		return this->invoke<unsigned char>([&](ErrorFlags * flags) {
+			return bid::to_uint8_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator unsigned short() const { 
+		return this->invoke<unsigned short>([&](ErrorFlags * flags) {
+			return bid::to_uint16_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+
+	explicit operator unsigned int() const { 
+		return this->invoke<unsigned int>([&](ErrorFlags * flags) {
+			return bid::to_uint32_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator unsigned long() const { 
 		return this->invoke<unsigned long>([&](ErrorFlags * flags) {
-			return this->to_uint64_xrnint (this->_val, flags);
-		}, this->_throw);
+			return bid::to_uint64_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator unsigned long long() const { 
+		return this->invoke<unsigned long long>([&](ErrorFlags * flags) {
+			return bid::to_uint64_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator char() const { 
+		return this->invoke<char>([&](ErrorFlags * flags) {
+			return bid::to_int8_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator short() const { 
+		return this->invoke<short>([&](ErrorFlags * flags) {
+			return bid::to_int16_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+
+	explicit operator int() const { 
+		return this->invoke<int>([&](ErrorFlags * flags) {
+			return bid::to_int32_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator long() const { 
+		return this->invoke<long>([&](ErrorFlags * flags) {
+			return bid::to_int64_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator long long() const { 
+		return this->invoke<long long>([&](ErrorFlags * flags) {
+			return bid::to_int64_xrnint(this->_val, flags);
+		}, DecimalBase::traps());
+	}
+	
+	explicit operator float() const { 
+		return this->invoke<float>([&](ErrorFlags * flags) {
+			return bid::to_binary32(this->_val, DecimalBase::rounding(), flags);
+		}, DecimalBase::traps());
+	}
+
+	explicit operator double() const { 
+		return this->invoke<double>([&](ErrorFlags * flags) {
+			return bid::to_binary64(this->_val, DecimalBase::rounding(), flags);
+		}, DecimalBase::traps());
+	}
+
+	// == comparison operators == //
+	// Each comparison is a single call to bid::compare;
+	// <, <=, > and >= are rewritten by the compiler in terms of <=>.
+	// NaNs are unordered, so they compare unequal to everything, themselves included.
+	friend inline bool operator==(const DecimalBase & l, const DecimalBase & r) { 
+		return (DecimalBase::invoke<int>([&](ErrorFlags * flags) {
+			return bid::compare(l._val, r._val, flags);
+		}, DecimalBase::traps()) == 0);
+	}
+
+	friend inline std::partial_ordering operator<=>(const DecimalBase & l, const DecimalBase & r) {
+		const int order = DecimalBase::invoke<int>([&](ErrorFlags * flags) {
+			return bid::compare(l._val, r._val, flags);
+		}, DecimalBase::traps());
+		switch (order) {
+			case -1: return std::partial_ordering::less;
+			case 0: return std::partial_ordering::equivalent;
+			case 1: return std::partial_ordering::greater;
+			default: return std::partial_ordering::unordered;
+		}
+	}
+		
+	friend inline std::ostream& operator<<(std::ostream& stream, DecimalBase & decimal) {
+		stream << decimal.str();
+		return stream;
+	}	
+
+	friend inline const D truncate(const D & v) {
+		auto t = DecimalBase::invoke<T>([&](ErrorFlags * flags) {
+			return bid::round_integral_zero (v._val, flags);
+		}, DecimalBase::traps());
+		return make(t);
+	}
+
+	// rounds v to the exponent of pattern, e.g. quantize(price, tick)
+	friend inline const D quantize(const D & v, const D & pattern) {
+		return binary_op<bid::quantize>(v, pattern);
+	}
+
+	friend inline const D abs(const D & v) {
+		return make(bid::abs(v._val));
+	}	
+
+	friend inline const D operator-(const D & v) {
+		return make(bid::negate(v._val));
+	}	
+	
+	// == arithmetic operators == //	
+	friend inline const D operator+(const D & l, const D & r) {
+		return binary_op<bid::add>(l, r);
+	}	
+	
+	friend inline const D operator-(const D & l, const D & r) {
+		return binary_op<bid::sub>(l, r);
+	}	
+	
+	friend inline const D operator*(const D & l, const D & r) {
+		return binary_op<bid::mul>(l, r);
+	}	
+	
+	friend inline const D operator/(const D & l, const D & r) {
+		return binary_op<bid::div>(l, r);
+	}	
+
+	// == non-throwing arithmetic == //
+	// These round with the given mode instead of the context's,
+	// add the raised flags to *flags instead of the context's errors,
+	// and never throw, so flags can be checked once after many operations.
+	friend inline const D add(const D & l, const D & r, const RoundMode round_mode, ErrorFlags * flags) noexcept {
+		return make(bid::add(l._val, r._val, round_mode, flags));
+	}
+
+	friend inline const D sub(const D & l, const D & r, const RoundMode round_mode, ErrorFlags * flags) noexcept {
+		return make(bid::sub(l._val, r._val, round_mode, flags));
+	}
+
+	friend inline const D mul(const D & l, const D & r, const RoundMode round_mode, ErrorFlags * flags) noexcept {
+		return make(bid::mul(l._val, r._val, round_mode, flags));
+	}
+
+	friend inline const D div(const D & l, const D & r, const RoundMode round_mode, ErrorFlags * flags) noexcept {
+		return make(bid::div(l._val, r._val, round_mode, flags));
+	}
+
+	// l * r + a with a single rounding
+	friend inline const D fma(const D & l, const D & r, const D & a, const RoundMode round_mode, ErrorFlags * flags) noexcept {
+		return make(bid::fma(l._val, r._val, a._val, round_mode, flags));
+	}
+	
+	// == coefficient and exponent == //
+	// the parts of a finite value, read from the bits;
+	// a non-canonical coefficient reads as zero.
+	// NaN and infinity have no parts, so they give {sign, 0, 0} 
+	// and Error::Invalid is added to *flags
+	constexpr Decomposed decompose(ErrorFlags * flags) const noexcept {
+		const bool negative = bid::is_signed(this->_val) != 0;
+		if (!bid::is_finite(this->_val)) {
+			*flags |= Error::Invalid;
+			return { negative, 0, 0 };
+		}
+		return { negative, bid::canonical_coefficient(this->_val), bid::exponent(this->_val) };
+	}
+
+	// as above, but throws an InvalidException for NaN and infinity
+	constexpr Decomposed decompose() const {
+		ErrorFlags flags = Error::None;
+		const Decomposed parts = this->decompose(&flags);
+		if (flags != Error::None) {
+			throw IDecimal::InvalidException("Non-finite decimal has no coefficient or exponent", flags, this);
+		}
+		return parts;
+	}
+
+	// builds a value from its parts without throwing, rounding when the coefficient 
+	// has too many digits or the exponent is out of range;
+	// the flags raised are added to *flags
+	static constexpr const D compose(const Decomposed & parts, const RoundMode round_mode, ErrorFlags * flags) noexcept {
+		return make(bid_round<T>(parts.negative, parts.coefficient, parts.exponent, false, round_mode, flags));
+	}
+
+	// builds a value from its parts, rounding and reporting errors under the policy
+	static const D compose(const Decomposed & parts) {
+		const typename D::policy policy;
+		ErrorFlags flags = Error::None;
+		auto val = bid_round<T>(parts.negative, parts.coefficient, parts.exponent, false, policy.round_mode(), &flags);
+		save_flags(policy, flags);
+		return make(val);
+	}
+
+	// a key whose byte order is the total order of values, see order_key
+	constexpr const typename decimal754::order_key<T>::bytes key() const noexcept {
+		return decimal754::order_key<T>::encode(this->_val);
+	}
+
+	static constexpr const D from_key(const typename decimal754::order_key<T>::bytes & key) noexcept {
+		return make(decimal754::order_key<T>::decode(key));
+	}
+
+	// equal values have equal hashes, whatever their encoding or width
+	constexpr size_t hash() const noexcept {
+		return static_cast<size_t>(bid_hash(this->_val));
+	}
+
+	// the encoded value, e.g. for storage
+	constexpr const T bits() const noexcept { 
+		return _val; 
+	}
+
+	// wraps an encoded value as is
+	static constexpr const D from_bits(const T value) noexcept { 
+		return make(value); 
+	}
+
+	// Generates a random decimal	
+	// Does not generate Inf, -Inf, NaN, or subnormal numbers
+	static const D random() { 	
+		auto result = random_str();
+		return D(result);
+	};	
+
+	// converts a decimal of another width without throwing;
+	// the flags raised by the conversion are added to *flags
+	template <class U, class E>
+	static const D convert(const DecimalBase<U, E> & value, const RoundMode round_mode, ErrorFlags * flags) {
+		return make(bid::from_bid(value._val, round_mode, flags));
+	}
+
+	// converts a column of decimals of another width in one pass,
+	// adding the flags raised by any element to *flags
+	template <class E>
+	static void convert(const std::span<const E> values, const std::span<D> result, const RoundMode round_mode, ErrorFlags * flags) {
+		assert(result.size() >= values.size());
+		for (size_t i = 0; i < values.size(); ++i) {
+			result[i]._val = bid::from_bid(values[i]._val, round_mode, flags);
+		}
+	}
+};
+
+class LongDecimal final : public DecimalBase<D128, LongDecimal> {
+private:
+	friend class DecimalBase<D128, LongDecimal>;
+    
+public:
+	using DecimalBase<D128, LongDecimal>::DecimalBase;
+
+	static constexpr short precision = bid::precision;
+	static constexpr short emax = bid::emax;
+	static constexpr short emin = bid::emin;
+};
+
+// 16 significant digits in 8 bytes
+class ShortDecimal final : public DecimalBase<D64, ShortDecimal> {
+private:
+	friend class DecimalBase<D64, ShortDecimal>;
+    
+public:
+	using DecimalBase<D64, ShortDecimal>::DecimalBase;
+
+	static constexpr short precision = bid::precision;
+	static constexpr short emax = bid::emax;
+	static constexpr short emin = bid::emin;
+};
+
+// 7 significant digits in 4 bytes, for compact storage
+class Decimal32 final : public DecimalBase<D32, Decimal32> {
+private:
+	friend class DecimalBase<D32, Decimal32>;
+    
+public:
+	using DecimalBase<D32, Decimal32>::DecimalBase;
+
+	static constexpr short precision = bid::precision;
+	static constexpr short emax = bid::emax;
+	static constexpr short emin = bid::emin;
+};
+
+// A decimal whose rounding mode and errors that throw are fixed at compile time,
+// e.g. BasicDecimal<D128, IDecimal::Round::TowardZero> for fees.
+// Its operations never read or write the thread's context,
+// so errors that do not throw are not recorded;
+// the non-throwing functions (add, sub, ...) report them instead.
+template <class T, 
+		  RoundMode R = IDecimal::Round::NearestEven, 
+		  ErrorFlags Traps = IDecimal::Error::Undefined>
+class BasicDecimal final : public DecimalBase<T, BasicDecimal<T, R, Traps>> {
+private:
+	typedef DecimalBase<T, BasicDecimal<T, R, Traps>> Base;
+	friend Base;
+
+	typedef StaticPolicy<R, Traps> policy;
+    
+public:
+	using Base::Base;
+
+	static constexpr short precision = Base::bid::precision;
+	static constexpr short emax = Base::bid::emax;
+	static constexpr short emin = Base::bid::emin;
+};
+
+static_assert(sizeof(LongDecimal) == sizeof(D128), "LongDecimal must hold nothing but its value");
+static_assert(std::is_trivially_copyable<LongDecimal>::value, "LongDecimal must be trivially copyable");
+static_assert(!std::is_polymorphic<LongDecimal>::value, "LongDecimal must not have a vtable");
+static_assert(sizeof(ShortDecimal) == sizeof(D64), "ShortDecimal must hold nothing but its value");
+static_assert(std::is_trivially_copyable<ShortDecimal>::value, "ShortDecimal must be trivially copyable");
+static_assert(!std::is_polymorphic<ShortDecimal>::value, "ShortDecimal must not have a vtable");
+static_assert(sizeof(Decimal32) == sizeof(D32), "Decimal32 must hold nothing but its value");
+static_assert(std::is_trivially_copyable<Decimal32>::value, "Decimal32 must be trivially copyable");
+static_assert(!std::is_polymorphic<Decimal32>::value, "Decimal32 must not have a vtable");
+
+// Parses decimal literals at compile time into the encoding of T,
+// rounding half-even like the default context.
+// As with the string constructors, the exponent may follow an E,
+// and Inf and NaN may be signed.
+// A literal that is malformed, overflows or underflows does not compile.
+template <class T>
+struct literal_parser {
+	typedef bid_traits<T> bid;
+	typedef unsigned __int128 uint128;
+
+	// the significant digits kept while parsing: a round digit and a sticky digit beyond any precision
+	static constexpr int max_digits = 36;
+
+	static consteval bool matches(const char * s, const size_t n, const char * word) {
+		size_t i = 0;
+		for (; i < n && word[i] != '\0'; ++i) {
+			const char c = (s[i] >= 'A' && s[i] <= 'Z')? static_cast<char>(s[i] - 'A' + 'a') : s[i];
+			if (c != word[i]) {
+				return false;
+			}
+		}
+		return i == n && word[i] == '\0';
+	}
+
+	static consteval T parse(const char * s, const size_t n) {
+		size_t i = 0;
+		bool negative = false;
+		if (i < n && (s[i] == '+' || s[i] == '-')) {
+			negative = (s[i] == '-');
+			++i;
+		}
+
+		if (matches(&s[i], n - i, "inf") || matches(&s[i], n - i, "infinity")) {
+			return bid::encode_inf(negative);
+		}
+		if (matches(&s[i], n - i, "nan")) {
+			return bid::encode_nan(negative);
+		}
+
+		// the significand: digits beyond max_digits only matter as sticky
+		uint128 c = 0;
+		int digits = 0;
+		int exponent = 0;
+		bool sticky = false;
+		bool any = false;
+		bool point = false;
+		for (; i < n; ++i) {
+			if (s[i] == '\'') {
+				continue; // digit separators
+			}
+			if (s[i] == '.' && !point) {
+				point = true;
+				continue;
+			}
+			if (s[i] < '0' || s[i] > '9') {
+				break;
+			}
+
+			any = true;
+			const int digit = s[i] - '0';
+			if (digits < max_digits) {
+				c = c * 10 + digit;
+				digits += (c != 0)? 1 : 0;
+				exponent -= point? 1 : 0;
+			} else {
+				sticky |= (digit != 0);
+				exponent += point? 0 : 1;
+			}
+		}
+		if (!any) {
+			throw IDecimal::Exception("A decimal literal needs at least one digit.");
+		}
+
+		// the exponent, which saturates well outside any format's range
+		if (i < n && (s[i] == 'e' || s[i] == 'E')) {
+			++i;
+			bool negative_exponent = false;
+			if (i < n && (s[i] == '+' || s[i] == '-')) {
+				negative_exponent = (s[i] == '-');
+				++i;
+			}
+			if (i == n) {
+				throw IDecimal::Exception("A decimal literal's exponent needs at least one digit.");
+			}
+			int e = 0;
+			for (; i < n && s[i] >= '0' && s[i] <= '9'; ++i) {
+				e = (e < 100000)? e * 10 + (s[i] - '0') : e;
+			}
+			exponent += negative_exponent? -e : e;
+		}
+		if (i != n) {
+			throw IDecimal::Exception("A decimal literal may only contain a sign, digits, a point and an exponent.");
+		}
+
+		return round(negative, c, exponent, sticky);
+	}
+
+	// rounds the parsed digits half-even to the precision and exponent range of T
+	static consteval T round(const bool negative, const uint128 c, const int exponent, const bool sticky) {
+		ErrorFlags flags = IDecimal::Error::None;
+		const T value = bid_round<T>(negative, c, exponent, sticky, IDecimal::Round::NearestEven, &flags);
+		if ((flags & IDecimal::Error::Underflow) != 0) {
+			throw IDecimal::UnderflowException("The decimal literal underflows.", flags);
+		}
+		if ((flags & IDecimal::Error::Overflow) != 0) {
+			throw IDecimal::OverflowException("The decimal literal overflows.", flags);
+		}
+		return value;
+	}
+};
+
+// Literals parsed at compile time, e.g.
+//	 using namespace decimal754::literals;
+//	 constexpr auto tick = 0.01_d64;
+//	 constexpr auto fee = "-0.0025"_d128;
+inline namespace literals {
+	consteval LongDecimal operator""_d128(const char * s) {
+		return LongDecimal::from_bits(literal_parser<D128>::parse(s, std::char_traits<char>::length(s)));
+	}
+
+	consteval LongDecimal operator""_d128(const char * s, const size_t n) {
+		return LongDecimal::from_bits(literal_parser<D128>::parse(s, n));
+	}
+
+	consteval ShortDecimal operator""_d64(const char * s) {
+		return ShortDecimal::from_bits(literal_parser<D64>::parse(s, std::char_traits<char>::length(s)));
+	}
+
+	consteval ShortDecimal operator""_d64(const char * s, const size_t n) {
+		return ShortDecimal::from_bits(literal_parser<D64>::parse(s, n));
+	}
+
+	consteval Decimal32 operator""_d32(const char * s) {
+		return Decimal32::from_bits(literal_parser<D32>::parse(s, std::char_traits<char>::length(s)));
+	}
+
+	consteval Decimal32 operator""_d32(const char * s, const size_t n) {
+		return Decimal32::from_bits(literal_parser<D32>::parse(s, n));
+	}
+}
+
+// The constants are encoded at compile time,
+// so they cost nothing at startup and are shared by every translation unit.
+namespace longDecimal {
+	inline constexpr LongDecimal Zero = 0_d128;
+	inline constexpr LongDecimal One = 1_d128;
+	inline constexpr LongDecimal Max = 9999999999999999999999999999999999E+6111_d128;
+	inline constexpr LongDecimal Min = "-9999999999999999999999999999999999E+6111"_d128;
+	inline constexpr LongDecimal SmallestPositive = 9999999999999999999999999999999999E-6176_d128;
+	inline constexpr LongDecimal SmallestNegative = "-9999999999999999999999999999999999E-6176"_d128;
+	inline constexpr LongDecimal Inf = "Inf"_d128;
+	inline constexpr LongDecimal NaN = "+NaN"_d128;
+}
+
+namespace shortDecimal {
+	inline constexpr ShortDecimal Zero = 0_d64;
+	inline constexpr ShortDecimal One = 1_d64;
+	inline constexpr ShortDecimal Max = 9999999999999999E+369_d64;
+	inline constexpr ShortDecimal Min = "-9999999999999999E+369"_d64;
+	inline constexpr ShortDecimal SmallestPositive = 9999999999999999E-398_d64;
+	inline constexpr ShortDecimal SmallestNegative = "-9999999999999999E-398"_d64;
+	inline constexpr ShortDecimal Inf = "Inf"_d64;
+	inline constexpr ShortDecimal NaN = "+NaN"_d64;
+}
+
+namespace decimal32 {
+	inline constexpr Decimal32 Zero = 0_d32;
+	inline constexpr Decimal32 One = 1_d32;
+	inline constexpr Decimal32 Max = 9999999E+90_d32;
+	inline constexpr Decimal32 Min = "-9999999E+90"_d32;
+	inline constexpr Decimal32 SmallestPositive = 9999999E-101_d32;
+	inline constexpr Decimal32 SmallestNegative = "-9999999E-101"_d32;
+	inline constexpr Decimal32 Inf = "Inf"_d32;
+	inline constexpr Decimal32 NaN = "+NaN"_d32;
+}
+
+// The members of std::numeric_limits for a decimal type D stored as T.
+// Exponents follow the usual definitions for radix 10, 
+// e.g. min() is the smallest normal value, 10^(emin + precision - 1).
+template <class T, class D, std::float_round_style Style>
+struct decimal_limits {
+	typedef bid_traits<T> bid;
+
+	static constexpr bool is_specialized = true;
+	static constexpr bool is_signed = true;
+	static constexpr bool is_integer = false;
+	static constexpr bool is_exact = false;
+	static constexpr bool has_infinity = true;
+	static constexpr bool has_quiet_NaN = true;
+	static constexpr bool has_signaling_NaN = true;
+	static constexpr std::float_denorm_style has_denorm = std::denorm_present;
+	static constexpr bool has_denorm_loss = false;
+	static constexpr std::float_round_style round_style = Style;
+	static constexpr bool is_iec559 = false; // IEC 559 covers binary formats only
+	static constexpr bool is_bounded = true;
+	static constexpr bool is_modulo = false;
+	static constexpr int digits = bid::precision;
+	static constexpr int digits10 = bid::precision;
+	static constexpr int max_digits10 = bid::precision;
+	static constexpr int radix = 10;
+	static constexpr int min_exponent = bid::emin + bid::precision;
+	static constexpr int min_exponent10 = bid::emin + bid::precision - 1;
+	static constexpr int max_exponent = bid::emax + bid::precision;
+	static constexpr int max_exponent10 = bid::emax + bid::precision - 1;
+	static constexpr bool traps = false;
+	static constexpr bool tinyness_before = true;
+
+	static constexpr D min() noexcept { return D::from_bits(bid::encode(false, 1, bid::emin + bid::precision - 1)); }
+	static constexpr D max() noexcept { return D::from_bits(bid::encode(false, pow10_128[bid::precision] - 1, bid::emax)); }
+	static constexpr D lowest() noexcept { return D::from_bits(bid::encode(true, pow10_128[bid::precision] - 1, bid::emax)); }
+	static constexpr D epsilon() noexcept { return D::from_bits(bid::encode(false, 1, 1 - bid::precision)); }
+	static constexpr D round_error() noexcept { return D::from_bits(bid::encode(false, 5, -1)); }
+	static constexpr D infinity() noexcept { return D::from_bits(bid::encode_inf(false)); }
+	static constexpr D quiet_NaN() noexcept { return D::from_bits(bid::encode_nan(false)); }
+	static constexpr D signaling_NaN() noexcept { return D::from_bits(bid::encode_snan(false)); }
+	static constexpr D denorm_min() noexcept { return D::from_bits(bid::encode(false, 1, bid::emin)); }
+};
+
+// the rounding style of a fixed rounding mode
+constexpr std::float_round_style round_style(const RoundMode round_mode) {
+	switch (round_mode) {
+		case IDecimal::Round::Downward: return std::round_toward_neg_infinity;
+		case IDecimal::Round::Upward: return std::round_toward_infinity;
+		case IDecimal::Round::TowardZero: return std::round_toward_zero;
+		default: return std::round_to_nearest;
+	}
+}
+
+// how sort() reads the storage of raw values and of decimals
+template <class X>
+struct sort_value {
+	typedef X storage;
+	static constexpr X bits(const X x) { return x; }
+	static constexpr X make(const X x) { return x; }
+};
+
+template <class X> requires std::is_base_of_v<IDecimal, X>
+struct sort_value<X> {
+	typedef std::remove_cv_t<decltype(std::declval<const X &>().bits())> storage;
+	static constexpr storage bits(const X & x) { return x.bits(); }
+	static constexpr X make(const storage x) { return X::from_bits(x); }
+};
+
+// Least significant digit radix sort of records on their keys, one byte per pass.
+// All the byte counts are taken in one read, and a byte on which every key agrees
+// (such as a shared exponent) costs no pass. 
+// Passes alternate between records and scratch, of the same size; the result ends in records.
+template <class Record, class Key>
+void radix_sort(const std::span<Record> records, const std::span<Record> scratch, const Key key) {
+	constexpr size_t width = std::tuple_size_v<std::remove_cvref_t<decltype(key(records[0]))>>;
+	const size_t n = records.size();
+	assert(scratch.size() >= n);
+	if (n < 2) {
+		return;
+	}
+
+	std::vector<std::array<size_t, 256>> counts(width);
+	for (const Record & record : records) {
+		const auto & k = key(record);
+		for (size_t b = 0; b < width; ++b) {
+			++counts[b][k[b]];
+		}
+	}
+
+	Record * from = records.data();
+	Record * to = scratch.data();
+	for (size_t b = width; b-- > 0; ) {
+		auto & count = counts[b];
+		if (count[key(*from)[b]] == n) {
+			continue;
+		}
+		size_t offset = 0;
+		for (size_t & c : count) {
+			const size_t k = c;
+			c = offset;
+			offset += k;
+		}
+		for (size_t i = 0; i < n; ++i) {
+			to[count[key(from[i])[b]]++] = from[i];
+		}
+		std::swap(from, to);
+	}
+	if (from != records.data()) {
+		std::copy(from, from + n, records.data());
+	}
+}
+
+// Sorts values by the keys encode() makes of them and decodes the keys back, 
+// carrying payload[i] along with values[i] unless the payload is empty
+template <class Bytes, class X, class V, class Encode, class Decode>
+void sort_by_key(const std::span<X> values, const std::span<V> payload, const Encode encode, const Decode decode) {
+	if (payload.empty()) {
+		std::vector<Bytes> records(values.size()), scratch(values.size());
+		for (size_t i = 0; i < values.size(); ++i) {
+			records[i] = encode(values[i]);
+		}
+		radix_sort(std::span<Bytes>(records), std::span<Bytes>(scratch), [](const Bytes & k) -> const Bytes & { return k; });
+		for (size_t i = 0; i < values.size(); ++i) {
+			values[i] = decode(records[i]);
+		}
+		return;
+	}
+
+	struct record {
+		Bytes key;
+		uint32_t index;
+	};
+	assert(payload.size() == values.size());
+	assert(values.size() <= std::numeric_limits<uint32_t>::max());
+	std::vector<record> records(values.size()), scratch(values.size());
+	for (size_t i = 0; i < values.size(); ++i) {
+		records[i] = record{encode(values[i]), static_cast<uint32_t>(i)};
+	}
+	radix_sort(std::span<record>(records), std::span<record>(scratch), [](const record & r) -> const Bytes & { return r.key; });
+
+	const std::vector<V> original(payload.begin(), payload.end());
+	for (size_t i = 0; i < values.size(); ++i) {
+		values[i] = decode(records[i].key);
+		payload[i] = original[records[i].index];
+	}
+}
+
+// Sorts decimals, or their raw storage, into the total order of IEEE 754 (see order_key),
+// carrying payload[i] along with values[i]. The sort is stable, 
+// so a payload of 0, 1, 2 ... comes out as the sorting permutation.
+// Values are sorted as keys and decoded back, so non-canonical encodings come out canonical.
+template <class X, class V>
+void sort(const std::span<X> values, const std::span<V> payload) {
+	typedef sort_value<X> value;
+	typedef typename value::storage T;
+	typedef bid_traits<T> bid;
+	typedef unsigned __int128 uint128;
+
+	// A column of finite values with one exponent, such as the prices of an instrument,
+	// orders by sign and coefficient alone, which takes a key of the storage width.
+	// Any other column needs the full order_key.
+	bool shared = true;
+	const int exponent = values.empty()? 0 : bid::exponent(value::bits(values[0]));
+	for (size_t i = 0; i < values.size() && shared; ++i) {
+		const T x = value::bits(values[i]);
+		shared = bid::is_canonical(x) && !bid::is_inf(x) && !bid::is_nan(x) && bid::exponent(x) == exponent;
+	}
+
+	if (shared) {
+		typedef std::array<uint8_t, sizeof(T)> bytes;
+		constexpr uint128 positive = static_cast<uint128>(1) << (sizeof(T) * 8 - 1);
+		sort_by_key<bytes>(values, payload, 
+			[](const X & x) {
+				const T bits = value::bits(x);
+				const uint128 c = bid::canonical_coefficient(bits);
+				const uint128 k = bid::is_signed(bits)? (positive - 1 - c) : (positive | c);
+				bytes key;
+				for (size_t b = 0; b < sizeof(T); ++b) {
+					key[b] = static_cast<uint8_t>(k >> ((sizeof(T) - 1 - b) * 8));
+				}
+				return key;
+			},
+			[exponent](const bytes & key) {
+				uint128 k = 0;
+				for (size_t b = 0; b < sizeof(T); ++b) {
+					k = (k << 8) | key[b];
+				}
+				const bool negative = (k & positive) == 0;
+				return value::make(bid::encode(negative, negative? (positive - 1 - k) : (k & (positive - 1)), exponent));
+			});
+	} else {
+		typedef order_key<T> key;
+		sort_by_key<typename key::bytes>(values, payload,
+			[](const X & x) { return key::encode(value::bits(x)); },
+			[](const typename key::bytes & k) { return value::make(key::decode(k)); });
+	}
+}
+
+template <class X>
+void sort(const std::span<X> values) {
+	decimal754::sort(values, std::span<uint32_t>());
+}
+
+// == vectorized BID64 kernels == //
+// Prices of one instrument almost always share an exponent. For two finite values 
+// in the small coefficient form with the same exponent, addition and comparison are
+// integer operations on the coefficients: the sum is exact, raising nothing, 
+// unless it carries out of the small form, and the exponent is unchanged. 
+// These kernels run that case on 4 (AVX2) or 8 (AVX-512) lanes at a time 
+// and hand any other lane (another exponent, a special value, the large form, a carry)
+// to the engine, so results and flags match it bit for bit. 
+// The widest instruction set the CPU supports is picked at run time.
+struct bid64_simd {
+	enum Level: unsigned int {
+		Scalar = 0,
+		AVX2 = 1,
+		AVX512 = 2
+	};
+
+	typedef bid_traits<D64> bid;
+
+	static constexpr uint64_t sign_mask = bid64_engine::sign_mask;
+	static constexpr uint64_t steering_mask = bid64_engine::steering_mask;
+	static constexpr uint64_t exponent_mask = 0x7fe0000000000000ull;
+	static constexpr uint64_t coefficient_mask = bid64_engine::small_coefficient_mask;
+	static constexpr uint64_t carry = coefficient_mask + 1;
+
+	// the widest kernels this CPU runs
+	static Level supported() {
+#ifdef DECIMAL754_X86_SIMD
+		static const Level level = []() {
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx512f")? AVX512 : (__builtin_cpu_supports("avx2")? AVX2 : Scalar);
+		}();
+		return level;
+#else
+		return Scalar;
+#endif
 	}
-	
-	explicit operator unsigned long long() const { 
-		return this->invoke<unsigned long long>([&](ErrorFlags * flags) {
-			return this->to_uint64_xrnint (this->_val, flags);
-		}, this->_throw);
+
+	// out[i] = a[i] + b[i], or a[i] - b[i] when subtracting
+	static void add(const std::span<const D64> a, const std::span<const D64> b, const std::span<D64> out, const bool subtract,
+			const RoundMode rnd_mode, ErrorFlags & flags, const Level level = supported()) noexcept {
+		assert(b.size() == a.size() && out.size() >= a.size());
+		ErrorFlags raised = 0;
+		size_t i = 0;
+#ifdef DECIMAL754_X86_SIMD
+		if (level >= AVX512) {
+			i = add_avx512(a.data(), b.data(), out.data(), a.size(), subtract, rnd_mode, raised);
+		} else if (level >= AVX2) {
+			i = add_avx2(a.data(), b.data(), out.data(), a.size(), subtract, rnd_mode, raised);
+		}
+#endif
+		for (; i < a.size(); ++i) {
+			out[i] = add(a[i], b[i], subtract, rnd_mode, &raised);
+		}
+		flags |= raised;
 	}
-	
-	explicit operator char() const { 
-		return this->invoke<char>([&](ErrorFlags * flags) {
-			return this->to_int8_xrnint(this->_val, flags);
-		}, this->_throw);
+
+	// out[i] is -1, 0 or 1 as a[i] is less than, equal to or greater than b[i], 2 when unordered
+	static void compare(const std::span<const D64> a, const std::span<const D64> b, const std::span<int8_t> out, 
+			ErrorFlags & flags, const Level level = supported()) noexcept {
+		assert(b.size() == a.size() && out.size() >= a.size());
+		ErrorFlags raised = 0;
+		size_t i = 0;
+#ifdef DECIMAL754_X86_SIMD
+		if (level >= AVX512) {
+			i = compare_avx512(a.data(), b.data(), out.data(), a.size(), raised);
+		} else if (level >= AVX2) {
+			i = compare_avx2(a.data(), b.data(), out.data(), a.size(), raised);
+		}
+#endif
+		for (; i < a.size(); ++i) {
+			out[i] = static_cast<int8_t>(bid::compare(a[i], b[i], &raised));
+		}
+		flags |= raised;
 	}
-	
-	explicit operator short() const { 
-		return this->invoke<short>([&](ErrorFlags * flags) {
-			return this->to_int16_xrnint(this->_val, flags);
-		}, this->_throw);
+
+private:
+	static constexpr D64 add(const D64 x, const D64 y, const bool subtract, const RoundMode rnd_mode, ErrorFlags * pfpsf) {
+		return subtract? bid::sub(x, y, rnd_mode, pfpsf) : bid::add(x, y, rnd_mode, pfpsf);
 	}
 
-	explicit operator int() const { 
-		return this->invoke<int>([&](ErrorFlags * flags) {
-			return this->to_int32_xrnint(this->_val, flags);
-		}, this->_throw);
+#ifdef DECIMAL754_X86_SIMD
+	// each kernel returns how many values it did, leaving the rest to the scalar loop
+	__attribute__((target("avx2")))
+	static size_t add_avx2(const D64 * a, const D64 * b, D64 * out, const size_t n, const bool subtract, 
+			const RoundMode rnd_mode, ErrorFlags & raised) {
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i ones = _mm256_set1_epi64x(-1);
+		const __m256i sign = _mm256_set1_epi64x(sign_mask);
+		const __m256i steering = _mm256_set1_epi64x(steering_mask);
+		const __m256i exponent = _mm256_set1_epi64x(exponent_mask);
+		const __m256i coefficient = _mm256_set1_epi64x(coefficient_mask);
+		const __m256i overflow = _mm256_set1_epi64x(carry);
+		const __m256i flip = subtract? sign : zero;
+		// the sign of an exact zero difference
+		const __m256i zero_sign = (rnd_mode == IDecimal::Round::Downward)? sign : zero;
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+			const __m256i y = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)), flip);
+			const __m256i cx = _mm256_and_si256(x, coefficient);
+			const __m256i cy = _mm256_and_si256(y, coefficient);
+			const __m256i same = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_xor_si256(x, y), sign), zero);
+
+			// same signs add the coefficients; opposite signs subtract the smaller from the larger
+			const __m256i sum = _mm256_add_epi64(cx, cy);
+			const __m256i diff = _mm256_sub_epi64(cx, cy);
+			const __m256i less = _mm256_cmpgt_epi64(zero, diff);
+			const __m256i magnitude = _mm256_blendv_epi8(diff, _mm256_sub_epi64(zero, diff), less);
+			__m256i diff_sign = _mm256_blendv_epi8(_mm256_and_si256(x, sign), _mm256_and_si256(y, sign), less);
+			diff_sign = _mm256_blendv_epi8(diff_sign, zero_sign, _mm256_cmpeq_epi64(diff, zero));
+			const __m256i result = _mm256_or_si256(_mm256_and_si256(x, exponent), _mm256_blendv_epi8(
+				_mm256_or_si256(diff_sign, magnitude), _mm256_or_si256(_mm256_and_si256(x, sign), sum), same));
+
+			// lanes in the large form or a special value, with another exponent, or carrying
+			__m256i other = _mm256_or_si256(_mm256_cmpeq_epi64(_mm256_and_si256(x, steering), steering), 
+				_mm256_cmpeq_epi64(_mm256_and_si256(y, steering), steering));
+			other = _mm256_or_si256(other, _mm256_xor_si256(ones, 
+				_mm256_cmpeq_epi64(_mm256_and_si256(_mm256_xor_si256(x, y), exponent), zero)));
+			other = _mm256_or_si256(other, _mm256_and_si256(same, _mm256_cmpeq_epi64(_mm256_and_si256(sum, overflow), overflow)));
+
+			int lanes = _mm256_movemask_pd(_mm256_castsi256_pd(other));
+			if (lanes == 0) {
+				_mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), result);
+				continue;
+			}
+			// out may be a or b, so the engine reads them before anything is stored
+			alignas(32) D64 lane_results[4];
+			_mm256_store_si256(reinterpret_cast<__m256i *>(lane_results), result);
+			for (; lanes != 0; lanes &= lanes - 1) {
+				const int lane = __builtin_ctz(lanes);
+				lane_results[lane] = add(a[i + lane], b[i + lane], subtract, rnd_mode, &raised);
+			}
+			std::copy(lane_results, lane_results + 4, out + i);
+		}
+		return i;
 	}
-	
-	explicit operator long() const { 
-		return this->invoke<long>([&](ErrorFlags * flags) {
-			return this->to_int64_xrnint(this->_val, flags);
-		}, this->_throw);
+
+	__attribute__((target("avx512f")))
+	static size_t add_avx512(const D64 * a, const D64 * b, D64 * out, const size_t n, const bool subtract, 
+			const RoundMode rnd_mode, ErrorFlags & raised) {
+		const __m512i zero = _mm512_setzero_si512();
+		const __m512i sign = _mm512_set1_epi64(sign_mask);
+		const __m512i steering = _mm512_set1_epi64(steering_mask);
+		const __m512i exponent = _mm512_set1_epi64(exponent_mask);
+		const __m512i coefficient = _mm512_set1_epi64(coefficient_mask);
+		const __m512i overflow = _mm512_set1_epi64(carry);
+		const __m512i flip = subtract? sign : zero;
+		// the sign of an exact zero difference
+		const __m512i zero_sign = (rnd_mode == IDecimal::Round::Downward)? sign : zero;
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m512i x = _mm512_loadu_si512(a + i);
+			const __m512i y = _mm512_xor_si512(_mm512_loadu_si512(b + i), flip);
+			const __m512i cx = _mm512_and_si512(x, coefficient);
+			const __m512i cy = _mm512_and_si512(y, coefficient);
+			const __mmask8 same = _mm512_testn_epi64_mask(_mm512_xor_si512(x, y), sign);
+
+			// same signs add the coefficients; opposite signs subtract the smaller from the larger
+			const __m512i sum = _mm512_add_epi64(cx, cy);
+			const __m512i diff = _mm512_sub_epi64(cx, cy);
+			const __mmask8 less = _mm512_cmplt_epi64_mask(diff, zero);
+			__m512i diff_sign = _mm512_mask_blend_epi64(less, _mm512_and_si512(x, sign), _mm512_and_si512(y, sign));
+			diff_sign = _mm512_mask_blend_epi64(_mm512_cmpeq_epi64_mask(diff, zero), diff_sign, zero_sign);
+			const __m512i result = _mm512_or_si512(_mm512_and_si512(x, exponent), _mm512_mask_blend_epi64(same,
+				_mm512_or_si512(diff_sign, _mm512_abs_epi64(diff)), _mm512_or_si512(_mm512_and_si512(x, sign), sum)));
+
+			// lanes in the large form or a special value, with another exponent, or carrying
+			unsigned int lanes = _mm512_cmpeq_epi64_mask(_mm512_and_si512(x, steering), steering) 
+				| _mm512_cmpeq_epi64_mask(_mm512_and_si512(y, steering), steering)
+				| _mm512_test_epi64_mask(_mm512_xor_si512(x, y), exponent)
+				| (same & _mm512_test_epi64_mask(sum, overflow));
+			if (lanes == 0) {
+				_mm512_storeu_si512(out + i, result);
+				continue;
+			}
+			// out may be a or b, so the engine reads them before anything is stored
+			alignas(64) D64 lane_results[8];
+			_mm512_store_si512(lane_results, result);
+			for (; lanes != 0; lanes &= lanes - 1) {
+				const int lane = __builtin_ctz(lanes);
+				lane_results[lane] = add(a[i + lane], b[i + lane], subtract, rnd_mode, &raised);
+			}
+			std::copy(lane_results, lane_results + 8, out + i);
+		}
+		return i;
 	}
-	
-	explicit operator long long() const { 
-		return this->invoke<long long>([&](ErrorFlags * flags) {
-			return this->to_int64_xrnint(this->_val, flags);
-		}, this->_throw);
+
+	// In the fast case, the signed coefficients order the values.
+	__attribute__((target("avx2")))
+	static size_t compare_avx2(const D64 * a, const D64 * b, int8_t * out, const size_t n, ErrorFlags & raised) {
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i ones = _mm256_set1_epi64x(-1);
+		const __m256i one = _mm256_set1_epi64x(1);
+		const __m256i steering = _mm256_set1_epi64x(steering_mask);
+		const __m256i exponent = _mm256_set1_epi64x(exponent_mask);
+		const __m256i coefficient = _mm256_set1_epi64x(coefficient_mask);
+
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+			const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+			const __m256i cx = _mm256_and_si256(x, coefficient);
+			const __m256i cy = _mm256_and_si256(y, coefficient);
+			// the sign bit makes a negative lane
+			const __m256i vx = _mm256_blendv_epi8(cx, _mm256_sub_epi64(zero, cx), _mm256_cmpgt_epi64(zero, x));
+			const __m256i vy = _mm256_blendv_epi8(cy, _mm256_sub_epi64(zero, cy), _mm256_cmpgt_epi64(zero, y));
+			const __m256i result = _mm256_or_si256(_mm256_and_si256(_mm256_cmpgt_epi64(vx, vy), one), _mm256_cmpgt_epi64(vy, vx));
+
+			__m256i other = _mm256_or_si256(_mm256_cmpeq_epi64(_mm256_and_si256(x, steering), steering), 
+				_mm256_cmpeq_epi64(_mm256_and_si256(y, steering), steering));
+			other = _mm256_or_si256(other, _mm256_xor_si256(ones, 
+				_mm256_cmpeq_epi64(_mm256_and_si256(_mm256_xor_si256(x, y), exponent), zero)));
+
+			alignas(32) int64_t lane_results[4];
+			_mm256_store_si256(reinterpret_cast<__m256i *>(lane_results), result);
+			for (int lane = 0; lane < 4; ++lane) {
+				out[i + lane] = static_cast<int8_t>(lane_results[lane]);
+			}
+			for (int lanes = _mm256_movemask_pd(_mm256_castsi256_pd(other)); lanes != 0; lanes &= lanes - 1) {
+				const int lane = __builtin_ctz(lanes);
+				out[i + lane] = static_cast<int8_t>(bid::compare(a[i + lane], b[i + lane], &raised));
+			}
+		}
+		return i;
 	}
-	
-	explicit operator float() const { 
-		return this->invoke<float>([&](ErrorFlags * flags) {
-			return this->to_binary32(this->_val, this->_round_mode, flags);
-		}, this->_throw);
+
+	__attribute__((target("avx512f")))
+	static size_t compare_avx512(const D64 * a, const D64 * b, int8_t * out, const size_t n, ErrorFlags & raised) {
+		const __m512i zero = _mm512_setzero_si512();
+		const __m512i one = _mm512_set1_epi64(1);
+		const __m512i ones = _mm512_set1_epi64(-1);
+		const __m512i sign = _mm512_set1_epi64(sign_mask);
+		const __m512i steering = _mm512_set1_epi64(steering_mask);
+		const __m512i exponent = _mm512_set1_epi64(exponent_mask);
+		const __m512i coefficient = _mm512_set1_epi64(coefficient_mask);
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const __m512i x = _mm512_loadu_si512(a + i);
+			const __m512i y = _mm512_loadu_si512(b + i);
+			const __m512i cx = _mm512_and_si512(x, coefficient);
+			const __m512i cy = _mm512_and_si512(y, coefficient);
+			// the sign bit makes a negative lane
+			const __m512i vx = _mm512_mask_sub_epi64(cx, _mm512_test_epi64_mask(x, sign), zero, cx);
+			const __m512i vy = _mm512_mask_sub_epi64(cy, _mm512_test_epi64_mask(y, sign), zero, cy);
+			__m512i result = _mm512_mask_mov_epi64(zero, _mm512_cmpgt_epi64_mask(vx, vy), one);
+			result = _mm512_mask_mov_epi64(result, _mm512_cmplt_epi64_mask(vx, vy), ones);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(out + i), _mm512_cvtepi64_epi8(result));
+
+			unsigned int lanes = _mm512_cmpeq_epi64_mask(_mm512_and_si512(x, steering), steering) 
+				| _mm512_cmpeq_epi64_mask(_mm512_and_si512(y, steering), steering)
+				| _mm512_test_epi64_mask(_mm512_xor_si512(x, y), exponent);
+			for (; lanes != 0; lanes &= lanes - 1) {
+				const int lane = __builtin_ctz(lanes);
+				out[i + lane] = static_cast<int8_t>(bid::compare(a[i + lane], b[i + lane], &raised));
+			}
+		}
+		return i;
 	}
+#endif
+};
 
-	explicit operator double() const { 
-		return this->invoke<float>([&](ErrorFlags * flags) {
-			return this->to_binary32(this->_val, this->_round_mode, flags);
-		}, this->_throw);
+// == batch arithmetic == //
+// Kernels over columns of raw storage: out[i] = a[i] op b[i] for every i, 
+// rounded with round_mode. Nothing throws, and the flags raised by the whole column 
+// are added to flags once at the end. out may be one of the operands.
+template <class T, T (*op)(const T, const T, const RoundMode, ErrorFlags *)>
+inline void binary_kernel(const std::span<const T> a, const std::span<const T> b, const std::span<T> out, 
+		const RoundMode round_mode, ErrorFlags & flags) noexcept {
+	assert(b.size() == a.size() && out.size() >= a.size());
+	ErrorFlags raised = 0;
+	for (size_t i = 0; i < a.size(); ++i) {
+		out[i] = op(a[i], b[i], round_mode, &raised);
 	}
+	flags |= raised;
+}
 
-	// == comparison operators == //
-	friend inline bool operator!=(const DecimalBase<T> & l, const DecimalBase<T> & r) { return !(l == r); }
-	friend inline bool operator==(const DecimalBase<T> & l, const DecimalBase<T> & r) { 
-		return (DecimalBase::invoke<int>([&](ErrorFlags * flags) {
-			return l.quiet_equal(l._val, r._val, flags);
-		}, l._throw | r._throw) > 0);
+template <class T>
+void add(const std::span<const std::type_identity_t<T>> a, const std::span<const std::type_identity_t<T>> b, const std::span<T> out, 
+		const RoundMode round_mode, ErrorFlags & flags) noexcept {
+	if constexpr (std::is_same_v<T, D64>) {
+		bid64_simd::add(a, b, out, false, round_mode, flags);
+	} else {
+		binary_kernel<T, bid_traits<T>::add>(a, b, out, round_mode, flags);
 	}
+}
 
-	friend inline bool operator>(const DecimalBase<T> & l, const DecimalBase<T> & r) { return r < l || l == r; }
-	friend inline bool operator<=(const DecimalBase<T> & l, const DecimalBase<T> & r) { return l < r || l == r; }
-	friend inline bool operator>=(const DecimalBase<T> & l, const DecimalBase<T> & r) { return l > r || l == r; }
-	friend inline bool operator<(const DecimalBase<T> & l, const DecimalBase<T> & r) {
-		return (DecimalBase::invoke<int>([&](ErrorFlags * flags) {
-			return l.quiet_less(l._val, r._val, flags);
-		}, l._throw | r._throw) > 0);
+template <class T>
+void sub(const std::span<const std::type_identity_t<T>> a, const std::span<const std::type_identity_t<T>> b, const std::span<T> out, 
+		const RoundMode round_mode, ErrorFlags & flags) noexcept {
+	if constexpr (std::is_same_v<T, D64>) {
+		bid64_simd::add(a, b, out, true, round_mode, flags);
+	} else {
+		binary_kernel<T, bid_traits<T>::sub>(a, b, out, round_mode, flags);
 	}
-		
-	friend inline std::ostream& operator<<(std::ostream& stream, DecimalBase<T> & decimal) {
-		stream << decimal.str();
-		return stream;
-	}	
+}
+
+template <class T>
+void mul(const std::span<const std::type_identity_t<T>> a, const std::span<const std::type_identity_t<T>> b, const std::span<T> out, 
+		const RoundMode round_mode, ErrorFlags & flags) noexcept {
+	binary_kernel<T, bid_traits<T>::mul>(a, b, out, round_mode, flags);
+}
+
+template <class T>
+void div(const std::span<const std::type_identity_t<T>> a, const std::span<const std::type_identity_t<T>> b, const std::span<T> out, 
+		const RoundMode round_mode, ErrorFlags & flags) noexcept {
+	binary_kernel<T, bid_traits<T>::div>(a, b, out, round_mode, flags);
+}
+
+// out[i] is -1, 0 or 1 as a[i] is less than, equal to or greater than b[i], 2 when unordered;
+// comparing a signaling NaN raises invalid
+template <class T>
+void compare(const std::span<const std::type_identity_t<T>> a, const std::span<const std::type_identity_t<T>> b, const std::span<int8_t> out, 
+		ErrorFlags & flags) noexcept {
+	if constexpr (std::is_same_v<T, D64>) {
+		bid64_simd::compare(a, b, out, flags);
+	} else {
+		assert(b.size() == a.size() && out.size() >= a.size());
+		ErrorFlags raised = 0;
+		for (size_t i = 0; i < a.size(); ++i) {
+			out[i] = static_cast<int8_t>(bid_traits<T>::compare(a[i], b[i], &raised));
+		}
+		flags |= raised;
+	}
+}
+
+// out[i] = a[i] * b[i] + c[i] with a single rounding
+template <class T>
+void fma(const std::span<const std::type_identity_t<T>> a, const std::span<const std::type_identity_t<T>> b, 
+		const std::span<const std::type_identity_t<T>> c, const std::span<T> out, const RoundMode round_mode, ErrorFlags & flags) noexcept {
+	assert(b.size() == a.size() && c.size() == a.size() && out.size() >= a.size());
+	ErrorFlags raised = 0;
+	for (size_t i = 0; i < a.size(); ++i) {
+		out[i] = bid_traits<T>::fma(a[i], b[i], c[i], round_mode, &raised);
+	}
+	flags |= raised;
+}
+
+// == columns == //
+// allocates on cache line boundaries, so vector kernels load whole lines
+template <class T, size_t Alignment = 64>
+struct aligned_allocator {
+	typedef T value_type;
+
+	template <class U>
+	struct rebind { typedef aligned_allocator<U, Alignment> other; };
+
+	aligned_allocator() noexcept = default;
+	template <class U>
+	aligned_allocator(const aligned_allocator<U, Alignment> &) noexcept {}
+
+	T * allocate(const size_t n) {
+		return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+	}
+
+	void deallocate(T * p, const size_t) noexcept {
+		::operator delete(p, std::align_val_t(Alignment));
+	}
+
+	template <class U>
+	friend bool operator==(const aligned_allocator &, const aligned_allocator<U, Alignment> &) noexcept { return true; }
 };
 
-class LongDecimal final : public DecimalBase<D128> {
-private:
-	void _attach_bid_functions() override {
-		this->to_string = bid128_to_string;
-		this->to_uint8_xrnint = bid128_to_uint8_xrnint;
-		this->to_uint16_xrnint = bid128_to_uint16_xrnint;
-		this->to_uint32_xrnint = bid128_to_uint32_xrnint;
-		this->to_uint64_xrnint = bid128_to_uint64_xrnint;
-		this->to_int8_xrnint = bid128_to_int8_xrnint;
-		this->to_int16_xrnint = bid128_to_int16_xrnint;
-		this->to_int32_xrnint = bid128_to_int32_xrnint;
-		this->to_int64_xrnint = bid128_to_int64_xrnint;
-		this->to_binary32 = bid128_to_binary32;
-		this->to_binary64 = bid128_to_binary64;
-		this->_is_signed = bid128_isSigned;
-		this->_is_normal = bid128_isNormal;
-		this->_is_zero = bid128_isZero;
-		this->quiet_equal = bid128_quiet_equal;
-		this->quiet_less = bid128_quiet_less;
-		this->round_integral_zero = bid128_round_integral_zero;
-		this->abs = bid128_abs;
-		this->negate = bid128_negate;
-		this->_add = bid128_add;
-		this->_sub = bid128_sub;
-		this->_mul = bid128_mul;
-		this->_div = bid128_div;
-	}
-
-	const unsigned short _precision() override { return LongDecimal::precision ; }
-	const unsigned short _emax() override { return LongDecimal::emax ; }
-	const unsigned short _emin() override { return LongDecimal::emin ; }
-
-	static const D128 from_string(const std::string & value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
-		auto val = value.empty()? "0" : value;
-		auto c = cstr( (value.empty()? "0" : value.c_str()) );
-		return DecimalBase::invoke<D128>([&](ErrorFlags * flags) {
-			return bid128_from_string(c.val, round_mode, flags);
-		}, throw_on_err);
+// A column of decimals of type D, stored as raw BID words in one aligned array,
+// so scans read nothing but the values and the batch kernels run on bits() directly.
+// The column tracks whether all its values are finite with one exponent,
+// the case in which the vector kernels do every lane.
+template <class D>
+class DecimalColumn {
+public:
+	typedef D value_type;
+	typedef std::remove_cv_t<decltype(std::declval<const D &>().bits())> storage;
+	typedef std::vector<storage, aligned_allocator<storage>> words;
+
+	// iterates over the values, reading each one from its word
+	class const_iterator {
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef D value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const D reference;
+		typedef void pointer;
+
+		const_iterator() = default;
+		explicit const_iterator(const storage * word) : _word(word) {}
+
+		const D operator*() const { return D::from_bits(*_word); }
+		const D operator[](const difference_type n) const { return D::from_bits(_word[n]); }
+
+		const_iterator & operator++() { ++_word; return *this; }
+		const_iterator & operator--() { --_word; return *this; }
+		const_iterator operator++(int) { const_iterator t = *this; ++_word; return t; }
+		const_iterator operator--(int) { const_iterator t = *this; --_word; return t; }
+		const_iterator & operator+=(const difference_type n) { _word += n; return *this; }
+		const_iterator & operator-=(const difference_type n) { _word -= n; return *this; }
+
+		friend const_iterator operator+(const_iterator i, const difference_type n) { return i += n; }
+		friend const_iterator operator+(const difference_type n, const_iterator i) { return i += n; }
+		friend const_iterator operator-(const_iterator i, const difference_type n) { return i -= n; }
+		friend difference_type operator-(const const_iterator & l, const const_iterator & r) { return l._word - r._word; }
+		friend bool operator==(const const_iterator & l, const const_iterator & r) = default;
+		friend auto operator<=>(const const_iterator & l, const const_iterator & r) = default;
+
+	private:
+		const storage * _word = nullptr;
+	};
+	typedef const_iterator iterator;
+
+	DecimalColumn() = default;
+	explicit DecimalColumn(const size_t n) : _words(n, D().bits()) {}
+	DecimalColumn(const std::initializer_list<D> values) : DecimalColumn(std::span<const D>(values.begin(), values.size())) {}
+
+	explicit DecimalColumn(const std::span<const D> values) {
+		_words.reserve(values.size());
+		for (const D & value : values) {
+			push_back(value);
+		}
 	}
-	
-	static const D128 from_cstring(const char * value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
-		auto val = (strcmp(value, "") == 0)? "0" : value;
-		auto c = cstr(val);
-		return DecimalBase::invoke<D128>([&](ErrorFlags * flags) {
-			return bid128_from_string(c.val, round_mode, flags);
-		}, throw_on_err);
+
+	size_t size() const { return _words.size(); }
+	bool empty() const { return _words.empty(); }
+	size_t capacity() const { return _words.capacity(); }
+	void reserve(const size_t n) { _words.reserve(n); }
+
+	void clear() { 
+		_words.clear(); 
+		_state = Unknown;
 	}
-	
-	static const D128 from_float(const float value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
-		return DecimalBase::invoke<D128>([&](ErrorFlags * flags) {
-			return binary32_to_bid128(value, round_mode, flags);
-		}, throw_on_err);
+
+	// new values are zero
+	void resize(const size_t n) {
+		if (n > size() && _state == Uniform && bid::exponent(D().bits()) != _exponent) {
+			_state = Mixed;
+		} else if (n < size() && _state == Mixed) {
+			// the odd values out may be gone
+			_state = Unknown;
+		}
+		_words.resize(n, D().bits());
 	}
 
-	static const D128 from_double(const double value, const RoundMode round_mode, const ErrorFlags throw_on_err) {
-		return DecimalBase::invoke<D128>([&](ErrorFlags * flags) {
-			return binary64_to_bid128(value, round_mode, flags);
-		}, throw_on_err);
+	const D operator[](const size_t i) const { return D::from_bits(_words[i]); }
+
+	void push_back(const D & value) {
+		const storage word = value.bits();
+		if (_words.empty()) {
+			_state = shared(word)? Uniform : Mixed;
+			_exponent = bid::exponent(word);
+		} else if (_state == Uniform && (!shared(word) || bid::exponent(word) != _exponent)) {
+			_state = Mixed;
+		}
+		_words.push_back(word);
 	}
-	
-	friend inline const LongDecimal binary_op(const LongDecimal & l, const LongDecimal & r, 
-											const std::function<D128(D128, D128, RoundMode, ErrorFlags*)> func) {
-		if (l._round_mode != r._round_mode) {
-			throw MismatchedRoundingException(l._round_mode, r._round_mode);
+
+	void set(const size_t i, const D & value) {
+		const storage word = value.bits();
+		if (_state != Uniform || !shared(word) || bid::exponent(word) != _exponent) {
+			// replacing the odd value out can make the column uniform again
+			_state = Unknown;
 		}
+		_words[i] = word;
+	}
 
-		ErrorFlags flags = Error::None;
-		auto val = func(l._val, r._val, l._round_mode, &flags);
-		check_flags(flags, l._throw | r._throw);
-		auto v = LongDecimal(val);
-		v._errors = flags;
-		return v;
+	const_iterator begin() const { return const_iterator(_words.data()); }
+	const_iterator end() const { return const_iterator(_words.data() + _words.size()); }
+
+	// the words, for the batch kernels; after writing through the mutable view
+	// the column checks its exponents each time it is asked, until it is next updated
+	std::span<const storage> bits() const { return _words; }
+	std::span<storage> bits() { 
+		_state = Unknown;
+		return _words; 
 	}
-    
-    LongDecimal(const D128 value,
-                const RoundMode round_mode = Round::NearestEven,
-                const ErrorFlags throw_on_err = Error::Undefined)
-        : DecimalBase<D128>(value, round_mode, throw_on_err) {
-        this->_attach_bid_functions();
-    }
-    
+
+	// true when the column is not empty and every value is finite with the same exponent,
+	// which is stored in exponent
+	bool shared_exponent(int & exponent) const {
+		if (_words.empty()) {
+			return false;
+		}
+		if (_state != Unknown) {
+			exponent = _exponent;
+			return (_state == Uniform);
+		}
+		exponent = bid::exponent(_words[0]);
+		for (const storage word : _words) {
+			if (!shared(word) || bid::exponent(word) != exponent) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+private:
+	typedef bid_traits<storage> bid;
+	enum State { Unknown, Uniform, Mixed };
+
+	// a value that can share an exponent: finite, in a canonical encoding
+	static constexpr bool shared(const storage word) {
+		return bid::is_canonical(word) && !bid::is_inf(word) && !bid::is_nan(word);
+	}
+
+	words _words;
+	State _state = Unknown;
+	int _exponent = 0;
+};
+
+// == exact summation == //
+// Sums decimals of type D exactly and rounds once, in result(), 
+// so the total does not depend on the order of the values.
+// The sum is a fixed-point number covering every exponent of the format, 
+// in limbs of 18 digits that may each be negative until the sum is read.
+// Values are first added to 128-bit pending sums, one for each of a few recent exponents,
+// which is all most columns of prices need.
+// The sum of exact zeros follows IEEE 754: -0 only when every value was -0, 
+// or when rounding downward and the values were not all +0.
+// A NaN among the values gives the default NaN, raising invalid if it was signaling,
+// and infinities of both signs give the default NaN with invalid.
+template <class D>
+class DecimalAccumulator {
 public:
-	static const short precision = 34;
-	static const short emax = 6111;
-	static const short emin = -6176;
-	
-	LongDecimal() : LongDecimal(static_cast<const int>(0)) {}
-
-	LongDecimal(const unsigned int value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(bid128_from_uint32(value), round_mode, throw_on_err) {}
-	
-	LongDecimal(const unsigned long long value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(bid128_from_uint64(value), round_mode, throw_on_err) {}
-
-	LongDecimal(const int value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(bid128_from_int32(value), round_mode, throw_on_err) {}
-
-	LongDecimal(const long long value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(bid128_from_int64(value), round_mode, throw_on_err) {}			
-
-	LongDecimal(const std::string & value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(LongDecimal::from_string(value, round_mode, throw_on_err), round_mode, throw_on_err) {}
-
-	LongDecimal(const char * value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined)
-		: LongDecimal(LongDecimal::from_cstring(value, round_mode, throw_on_err), round_mode, throw_on_err) {}
-
-	LongDecimal(const unsigned char value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(static_cast<unsigned int>(value), round_mode, throw_on_err) {}
-
-	LongDecimal(const unsigned short value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(static_cast<unsigned int>(value), round_mode, throw_on_err) {}
-
-	LongDecimal(const unsigned long value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(static_cast<unsigned long long>(value), round_mode, throw_on_err) {}
-	
-	LongDecimal(const char value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(static_cast<int>(value), round_mode, throw_on_err) {}
-
-	LongDecimal(const short value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(static_cast<int>(value), round_mode, throw_on_err) {}
-
-	LongDecimal(const long value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(static_cast<long long>(value), round_mode, throw_on_err) {}
-
-	LongDecimal(const float value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(LongDecimal::from_float(value, round_mode, throw_on_err), round_mode, throw_on_err) {}
-	
-	LongDecimal(const double value, 
-				const RoundMode round_mode = Round::NearestEven, 
-				const ErrorFlags throw_on_err = Error::Undefined) 
-		: LongDecimal(LongDecimal::from_double(value, round_mode, throw_on_err), round_mode, throw_on_err) {}
-	
-	LongDecimal(const LongDecimal & other)
-        : LongDecimal(other._val, other._round_mode, other._throw) {}
-    	
-	friend inline LongDecimal truncate(const LongDecimal & v) {
-		auto t = DecimalBase::invoke<D128>([&](ErrorFlags * flags) {
-			return v.round_integral_zero (v._val, flags);
-		}, v._throw);
-		return LongDecimal(t);
+	typedef std::remove_cv_t<decltype(std::declval<const D &>().bits())> storage;
+
+	void add(const D & value) {
+		add_bits(value.bits());
 	}
-		
-	friend inline LongDecimal abs(const LongDecimal & v) {
-		auto val2 = DecimalBase::invoke<D128>([&](ErrorFlags * flags) {
-			return v.abs(v._val);
-		}, v._throw);
-		return LongDecimal(val2);
-	}	
 
-	friend inline LongDecimal operator-(const LongDecimal & v) {
-		auto val2 = DecimalBase::invoke<D128>([&](ErrorFlags * flags) {
-			return v.negate(v._val);
-		}, v._throw);
-		return LongDecimal(val2);
-	}	
-	
-	// == arithmetic operators == //	
-	friend inline const LongDecimal operator+(const LongDecimal & l, const LongDecimal & r) {
-		return binary_op(l, r, l._add);
-	}	
-	
-	friend inline const LongDecimal operator-(const LongDecimal & l, const LongDecimal & r) {
-		return binary_op(l, r, l._sub);
-	}	
-	
-	friend inline const LongDecimal operator*(const LongDecimal & l, const LongDecimal & r) {
-		return binary_op(l, r, l._mul);
-	}	
-	
-	friend inline const LongDecimal operator/(const LongDecimal & l, const LongDecimal & r) {
-		return binary_op(l, r, l._div);
-	}	
-	
-	// Generates a random decimal	
-	// Does not generate Inf, -Inf, NaN, or subnormal numbers
-	static const LongDecimal random() { 	
-		auto result = random_str(LongDecimal::precision, LongDecimal::emin, LongDecimal::emax);
-		return LongDecimal(result);
-	};	
+	void add(const std::span<const D> values) {
+		for (const D & value : values) {
+			add_bits(value.bits());
+		}
+	}
+
+	// the words of a column, e.g. DecimalColumn::bits()
+	void add(const std::span<const storage> values) {
+		for (const storage value : values) {
+			add_bits(value);
+		}
+	}
+
+	// adds the values added to another accumulator, so partial sums can be combined;
+	// the sum is exact, so it does not matter how the values were split
+	void merge(const DecimalAccumulator & other) {
+		DecimalAccumulator flushed = other;
+		flushed.flush();
+		for (int i = 0; i < limbs; ++i) {
+			add_limb(flushed._limbs[i], i);
+		}
+		if (other._min_exponent < _min_exponent) {
+			_min_exponent = other._min_exponent;
+		}
+		_any |= other._any;
+		_nonzero |= other._nonzero;
+		_positive_zero |= other._positive_zero;
+		_negative_zero |= other._negative_zero;
+		_nan |= other._nan;
+		_signaling |= other._signaling;
+		_positive_inf |= other._positive_inf;
+		_negative_inf |= other._negative_inf;
+	}
+
+	// rounds the sum with round_mode, adding the flags raised to *flags
+	const D result(const RoundMode round_mode, ErrorFlags * flags) const noexcept {
+		constexpr ErrorFlags invalid = IDecimal::Error::Invalid;
+		if (_nan || (_positive_inf && _negative_inf)) {
+			if (_signaling || !_nan) {
+				*flags |= invalid;
+			}
+			return D::from_bits(bid::encode_nan(false));
+		}
+		if (_positive_inf || _negative_inf) {
+			return D::from_bits(bid::encode_inf(_negative_inf));
+		}
+
+		DecimalAccumulator total = *this;
+		total.flush();
+		return D::from_bits(total.round(round_mode, flags));
+	}
+
+	// rounds the sum under the policy of D
+	const D result() const {
+		return DecimalBase<storage, D>::with_policy([this](const RoundMode round_mode, ErrorFlags * flags) { 
+			return this->result(round_mode, flags).bits(); 
+		});
+	}
+
+private:
+	typedef bid_traits<storage> bid;
+	typedef unsigned __int128 uint128;
+
+	static constexpr int limb_digits = 18;
+	static constexpr int64_t base = 1000000000000000000ll;
+	// digit positions count from 10^emin; the limbs cover the largest value of the format,
+	// a pending sum of up to 38 digits, and 36 digits of growth
+	static constexpr int limbs = (bid::emax - bid::emin + 38) / limb_digits + 3;
+	// values added to the pending sum before it can overflow
+	static constexpr uint64_t pending_limit = 
+		((static_cast<uint128>(1) << 126) / pow10_128[bid::precision] > (static_cast<uint128>(1) << 62))? 
+		(1ull << 62) : static_cast<uint64_t>((static_cast<uint128>(1) << 126) / pow10_128[bid::precision]);
+
+	// a sum of values with one exponent, not yet in the limbs
+	struct pending {
+		__int128 sum = 0;
+		uint64_t count = 0;
+		int exponent = 0;
+	};
+	static constexpr int pending_slots = 8;
+
+	std::array<int64_t, limbs> _limbs = {};
+	std::array<pending, pending_slots> _pending = {};
+	int _min_exponent = bid::emax;
+	bool _any = false;			// any finite value
+	bool _nonzero = false;		// any non-zero finite value
+	bool _positive_zero = false;
+	bool _negative_zero = false;
+	bool _nan = false;
+	bool _signaling = false;
+	bool _positive_inf = false;
+	bool _negative_inf = false;
+
+	void add_bits(const storage x) {
+		if (bid::is_nan(x)) {
+			_nan = true;
+			_signaling |= static_cast<bool>(bid::is_snan(x));
+			return;
+		}
+		if (bid::is_inf(x)) {
+			(bid::is_signed(x)? _negative_inf : _positive_inf) = true;
+			return;
+		}
+
+		const bool negative = bid::is_signed(x);
+		const uint128 c = bid::canonical_coefficient(x);
+		const int e = bid::exponent(x);
+		_any = true;
+		if (e < _min_exponent) {
+			_min_exponent = e;
+		}
+		if (c == 0) {
+			(negative? _negative_zero : _positive_zero) = true;
+			return;
+		}
+		_nonzero = true;
+
+		pending & slot = _pending[static_cast<unsigned int>(e) % pending_slots];
+		if (slot.exponent != e || slot.count == pending_limit) {
+			flush(slot);
+			slot.exponent = e;
+		}
+		// without a branch, as signs are unpredictable
+		const __int128 sign = -static_cast<__int128>(negative);
+		slot.sum += (static_cast<__int128>(c) ^ sign) - sign;
+		++slot.count;
+	}
+
+	// moves the pending sums into the limbs
+	void flush() {
+		for (pending & slot : _pending) {
+			flush(slot);
+		}
+	}
+
+	void flush(pending & slot) {
+		if (slot.sum != 0) {
+			const bool negative = slot.sum < 0;
+			uint128 c = negative? -static_cast<uint128>(slot.sum) : static_cast<uint128>(slot.sum);
+			int position = slot.exponent - bid::emin;
+			for (; c != 0; c /= static_cast<uint64_t>(base), position += limb_digits) {
+				add_digits(negative, static_cast<uint64_t>(c % static_cast<uint64_t>(base)), position);
+			}
+		}
+		slot.sum = 0;
+		slot.count = 0;
+	}
+
+	// adds (-1)^negative * v * 10^position for v below 10^18,
+	// which falls on at most two limbs
+	void add_digits(const bool negative, const uint64_t v, const int position) {
+		const int i = position / limb_digits;
+		const int r = position % limb_digits;
+		const uint64_t split = static_cast<uint64_t>(pow10_128[limb_digits - r]);
+		const int64_t low = static_cast<int64_t>((v % split) * static_cast<uint64_t>(pow10_128[r]));
+		const int64_t high = static_cast<int64_t>(v / split);
+		add_limb(negative? -low : low, i);
+		if (high != 0) {
+			add_limb(negative? -high : high, i + 1);
+		}
+	}
+
+	// adds v, less than a limb's base in magnitude, to limb i, carrying as far as needed
+	void add_limb(int64_t v, int i) {
+		while (v != 0) {
+			assert(i < limbs);
+			int64_t & limb = _limbs[i];
+			limb += v;
+			v = 0;
+			if (limb >= base) {
+				limb -= base;
+				v = 1;
+			} else if (limb <= -base) {
+				limb += base;
+				v = -1;
+			}
+			++i;
+		}
+	}
+
+	// the digits of the magnitude from 10^position up, count of them (at most 37)
+	static uint128 digits_at(const std::array<int64_t, limbs> & magnitude, const int position, const int count) {
+		uint128 result = 0;
+		for (int i = (position + count - 1) / limb_digits; i >= position / limb_digits; --i) {
+			const int from = (position > i * limb_digits)? position - i * limb_digits : 0;
+			const int to = (position + count < (i + 1) * limb_digits)? position + count - i * limb_digits : limb_digits;
+			const uint64_t v = (static_cast<uint64_t>(magnitude[i]) / static_cast<uint64_t>(pow10_128[from])) 
+				% static_cast<uint64_t>(pow10_128[to - from]);
+			result = result * pow10_128[to - from] + v;
+		}
+		return result;
+	}
+
+	// rounds the flushed sum
+	storage round(const RoundMode round_mode, ErrorFlags * flags) const {
+		constexpr RoundMode downward = IDecimal::Round::Downward;
+		if (!_any) {
+			return bid::encode(false, 0, 0);
+		}
+
+		// the sign of the sum is that of its most significant limb
+		int top = limbs - 1;
+		while (top >= 0 && _limbs[top] == 0) {
+			--top;
+		}
+		if (top < 0) {
+			const bool negative = (_negative_zero && !_positive_zero && !_nonzero) ||
+				(round_mode == downward && (_nonzero || _negative_zero));
+			return bid::encode(negative, 0, _min_exponent);
+		}
+		const bool negative = _limbs[top] < 0;
+
+		// the magnitude, with every limb in [0, base)
+		std::array<int64_t, limbs> magnitude = {};
+		int64_t borrow = 0;
+		for (int i = 0; i <= top; ++i) {
+			int64_t v = (negative? -_limbs[i] : _limbs[i]) + borrow;
+			borrow = 0;
+			if (v < 0) {
+				v += base;
+				borrow = -1;
+			}
+			magnitude[i] = v;
+		}
+		while (magnitude[top] == 0) {
+			--top;
+		}
+
+		// the digits from the smallest exponent up, 
+		// or the leading 37 and whether anything below them is non-zero
+		const int digits = top * limb_digits + decimal_digits(static_cast<uint128>(magnitude[top]));
+		const int lowest = _min_exponent - bid::emin;
+		if (digits - lowest <= 37) {
+			return bid_round<storage>(negative, digits_at(magnitude, lowest, digits - lowest), _min_exponent, false, round_mode, flags);
+		}
+		const int position = digits - 37;
+		bool sticky = (static_cast<uint64_t>(magnitude[position / limb_digits]) % static_cast<uint64_t>(pow10_128[position % limb_digits])) != 0;
+		for (int i = 0; i < position / limb_digits && !sticky; ++i) {
+			sticky = (magnitude[i] != 0);
+		}
+		return bid_round<storage>(negative, digits_at(magnitude, position, 37), position + bid::emin, sticky, round_mode, flags);
+	}
 };
 
-namespace longDecimal {
-	static LongDecimal Zero(0);
-	static LongDecimal One(1);
-	static LongDecimal Max(std::string("9999999999999999999999999999999999") + "E+6111");
-	static LongDecimal Min(std::string("-9999999999999999999999999999999999") + "E+6111");
-	static LongDecimal SmallestPositive(std::string("9999999999999999999999999999999999") + "E-6176");
-	static LongDecimal SmallestNegative(std::string("-9999999999999999999999999999999999") + "E-6176");
-	static LongDecimal Inf("Inf");
-	static LongDecimal NaN("+NaN");
+// == parallel summation == //
+// Sums values (decimals of type D, or their words) on the given number of threads,
+// or one per core when threads is 0, each adding a contiguous part to its own accumulator.
+// The partial sums are exact, so the total is the same bit for bit however the work is split.
+template <class D, class X>
+DecimalAccumulator<D> parallel_accumulate(const std::span<const X> values, unsigned int threads) {
+	// below this many values per thread, starting a thread costs more than it saves
+	constexpr size_t min_part = 1 << 16;
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	const size_t parts = std::max<size_t>(1, std::min<size_t>(threads, values.size() / min_part));
+	const size_t part = (values.size() + parts - 1) / parts;
+
+	std::vector<DecimalAccumulator<D>> sums(parts);
+	{
+		// the calling thread adds the first part, and the workers are joined on leaving the scope
+		std::vector<std::jthread> workers;
+		workers.reserve(parts - 1);
+		for (size_t i = 1; i < parts; ++i) {
+			workers.emplace_back([&sums, values, part, i]() {
+				sums[i].add(values.subspan(i * part, std::min(part, values.size() - i * part)));
+			});
+		}
+		sums[0].add(values.subspan(0, std::min(part, values.size())));
+	}
+
+	for (size_t i = 1; i < parts; ++i) {
+		sums[0].merge(sums[i]);
+	}
+	return sums[0];
+}
+
+// the sum of a column rounded once, under the policy of the decimal type
+template <class D>
+const D parallel_sum(const std::span<const D> values, const unsigned int threads = 0) {
+	return parallel_accumulate<D>(values, threads).result();
+}
+
+inline const LongDecimal parallel_sum(const std::span<const D128> values, const unsigned int threads = 0) {
+	return parallel_accumulate<LongDecimal>(values, threads).result();
+}
+
+inline const ShortDecimal parallel_sum(const std::span<const D64> values, const unsigned int threads = 0) {
+	return parallel_accumulate<ShortDecimal>(values, threads).result();
+}
+
+inline const Decimal32 parallel_sum(const std::span<const D32> values, const unsigned int threads = 0) {
+	return parallel_accumulate<Decimal32>(values, threads).result();
 }
 
 } // namespace decimal754
 
+namespace std {
+
+// the types that follow the context report the default context's rounding
+template <>
+struct numeric_limits<decimal754::LongDecimal> 
+	: decimal754::decimal_limits<decimal754::D128, decimal754::LongDecimal, round_to_nearest> {};
+
+template <>
+struct numeric_limits<decimal754::ShortDecimal> 
+	: decimal754::decimal_limits<decimal754::D64, decimal754::ShortDecimal, round_to_nearest> {};
+
+template <>
+struct numeric_limits<decimal754::Decimal32> 
+	: decimal754::decimal_limits<decimal754::D32, decimal754::Decimal32, round_to_nearest> {};
+
+template <class T, decimal754::RoundMode R, decimal754::ErrorFlags Traps>
+struct numeric_limits<decimal754::BasicDecimal<T, R, Traps>> 
+	: decimal754::decimal_limits<T, decimal754::BasicDecimal<T, R, Traps>, decimal754::round_style(R)> {};
+
+// hashing by value lets decimals key unordered containers
+template <>
+struct hash<decimal754::LongDecimal> {
+	size_t operator()(const decimal754::LongDecimal & value) const noexcept { return value.hash(); }
+};
+
+template <>
+struct hash<decimal754::ShortDecimal> {
+	size_t operator()(const decimal754::ShortDecimal & value) const noexcept { return value.hash(); }
+};
+
+template <>
+struct hash<decimal754::Decimal32> {
+	size_t operator()(const decimal754::Decimal32 & value) const noexcept { return value.hash(); }
+};
+
+template <class T, decimal754::RoundMode R, decimal754::ErrorFlags Traps>
+struct hash<decimal754::BasicDecimal<T, R, Traps>> {
+	size_t operator()(const decimal754::BasicDecimal<T, R, Traps> & value) const noexcept { return value.hash(); }
+};
+
+} // namespace std
+
 #endif // DECIMAL_H
@@ -22,7 +22,11 @@
 
 #include <iomanip>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include "decimal.h"
 #include "catch.hpp"
 
@@ -126,6 +130,45 @@ TEST_CASE( "Constants", "[constants]" ) {
 			}
 		}
 	}
+
+	SECTION("Compile time") {
+		static_assert(longDecimal::Zero.bits() == D128{{0, 0x3040000000000000ull}});
+		static_assert(shortDecimal::One.bits() == 0x31c0000000000001ull);
+		static_assert(decimal32::Inf.bits() == 0x78000000u);
+		REQUIRE( longDecimal::NaN.bits() == d("+NaN").bits() );
+		REQUIRE( shortDecimal::SmallestNegative == ShortDecimal("-9999999999999999E-398") );
+		REQUIRE( decimal32::Max == Decimal32("9999999E+90") );
+	}
+
+	SECTION("Numeric limits") {
+		typedef numeric_limits<LongDecimal> limits;
+		static_assert(limits::is_specialized && limits::has_infinity && !limits::is_integer);
+		static_assert(limits::digits == 34 && limits::radix == 10);
+		static_assert(limits::max_exponent10 == 6144 && limits::min_exponent10 == -6143);
+		REQUIRE( limits::max() == longDecimal::Max );
+		REQUIRE( limits::lowest() == longDecimal::Min );
+		REQUIRE( limits::min() == d("1E-6143") );
+		REQUIRE( limits::min().is_normal() );
+		REQUIRE( !limits::denorm_min().is_normal() );
+		REQUIRE( limits::denorm_min() == d("1E-6176") );
+		REQUIRE( limits::epsilon() == d("1E-33") );
+		REQUIRE( d(1) + limits::epsilon() != d(1) );
+		REQUIRE( limits::round_error() == d("0.5") );
+		REQUIRE( limits::infinity() == longDecimal::Inf );
+		REQUIRE( limits::quiet_NaN() != limits::quiet_NaN() );
+		REQUIRE( limits::quiet_NaN().bits() == longDecimal::NaN.bits() );
+
+		REQUIRE( numeric_limits<ShortDecimal>::max() == shortDecimal::Max );
+		REQUIRE( numeric_limits<ShortDecimal>::min() == ShortDecimal("1E-383") );
+		REQUIRE( numeric_limits<ShortDecimal>::epsilon() == ShortDecimal("1E-15") );
+		REQUIRE( numeric_limits<Decimal32>::max() == decimal32::Max );
+		REQUIRE( numeric_limits<Decimal32>::min() == Decimal32("1E-95") );
+
+		typedef BasicDecimal<D64, IDecimal::Round::TowardZero> fee;
+		static_assert(numeric_limits<fee>::round_style == round_toward_zero);
+		static_assert(numeric_limits<LongDecimal>::round_style == round_to_nearest);
+		REQUIRE( numeric_limits<fee>::max().bits() == shortDecimal::Max.bits() );
+	}
 }
 
 TEST_CASE( "Errors", "[errors]" ) {
@@ -136,13 +179,27 @@ TEST_CASE( "Errors", "[errors]" ) {
 TEST_CASE( "Null constructor", "[null constructor]" ) {
 	REQUIRE_NOTHROW(d());
 	auto a = d();
-	REQUIRE( a.errors() == IDecimal::Error::None );
 	REQUIRE( !a.is_negative() );
 	REQUIRE( !a.is_normal() );
 	REQUIRE( a.is_zero() );
 	REQUIRE( static_cast<int>(a) == 0);
 	REQUIRE( a.str() == "+0E+0");
-	REQUIRE( a.round_mode() == IDecimal::Round::NearestEven );
+}
+
+TEST_CASE( "Layout", "[layout]" ) {
+	// a decimal holds nothing but its value
+	REQUIRE( sizeof(LongDecimal) == sizeof(D128) );
+	REQUIRE( std::is_trivially_copyable<LongDecimal>::value );
+	REQUIRE( !std::is_polymorphic<LongDecimal>::value );
+
+	// format parameters are compile-time constants
+	static_assert(bid_traits<D128>::precision == 34, "BID128 has 34 digits");
+	static_assert(bid_traits<D128>::emax == 6111, "BID128 emax");
+	static_assert(bid_traits<D128>::emin == -6176, "BID128 emin");
+	REQUIRE( LongDecimal::precision == bid_traits<D128>::precision );
+
+	vector<LongDecimal> v = { d(1), d(2), d(3) };
+	REQUIRE( reinterpret_cast<const D128 *>(v.data())[1] == reinterpret_cast<const D128 &>(v[1]) );
 }
 
 TEST_CASE( "Constructors: Copy", "[copy constructor]" ) {
@@ -157,8 +214,6 @@ TEST_CASE( "Constructors: Copy", "[copy constructor]" ) {
 	REQUIRE( static_cast<int64_t>(A) == static_cast<int64_t>(B) );
 	REQUIRE( A.is_negative() == B.is_negative() );
 	REQUIRE( A.is_normal() == B.is_normal() );
-	REQUIRE( A.round_mode() == B.round_mode() );
-	REQUIRE( A.throw_on_err() == B.throw_on_err() );
 
 	for (int i=0; i < LOOP_SIZE; ++i) {
 		auto a = dist(gen);
@@ -168,8 +223,6 @@ TEST_CASE( "Constructors: Copy", "[copy constructor]" ) {
 		REQUIRE( static_cast<int64_t>(A) == static_cast<int64_t>(B) );
 		REQUIRE( A.is_negative() == B.is_negative() );
 		REQUIRE( A.is_normal() == B.is_normal() );
-		REQUIRE( A.round_mode() == B.round_mode() );
-		REQUIRE( A.throw_on_err() == B.throw_on_err() );
 	}
 }
 
@@ -187,9 +240,7 @@ TEMPLATE_TEST_CASE( "Constructors: Integers", "[constructors][integers]",
 	for (int i=0; i < LOOP_SIZE; ++i) {
 		auto a = dist(gen);
 		auto A = d(a);
-		REQUIRE( A.errors() == IDecimal::Error::None );
 		REQUIRE( static_cast<TestType>(A) == a);
-		REQUIRE( A.round_mode() == IDecimal::Round::NearestEven );
 
 		if (a == 0) {
 			REQUIRE( A.is_zero() );
@@ -206,8 +257,7 @@ TEMPLATE_TEST_CASE( "Constructors: Integers", "[constructors][integers]",
 		}
 	
 		for (auto m = round_modes.begin(); m != round_modes.end(); ++m) {
-			auto b = d(a, *m);
-			REQUIRE( b.round_mode() == *m );
+			REQUIRE( d(a, *m) == A );
 		}
 	}
 }
@@ -223,15 +273,14 @@ TEMPLATE_TEST_CASE( "Constructors: Floating point", "[constructors][float]", flo
 	for (int i=0; i < LOOP_SIZE; ++i) {
 		auto a = dist(gen);
 		auto A = d(a);
-		REQUIRE( A.errors() == IDecimal::Error::None );
-		REQUIRE( A.round_mode() == IDecimal::Round::NearestEven );
 	
 		try {	
 			// conversion back to float must be exact or trigger an inexact exception
-			A.throw_on(IDecimal::Error::Inexact);
+			IDecimal::LocalContext local;
+			local->throw_on(IDecimal::Error::Inexact);
 			auto r = static_cast<TestType>(A);
 			REQUIRE( r == a);
-		} catch (IDecimal::InexactException) {
+		} catch (const IDecimal::InexactException &) {
 			continue;
 		}
 
@@ -250,8 +299,7 @@ TEMPLATE_TEST_CASE( "Constructors: Floating point", "[constructors][float]", flo
 		}
 	
 		for (auto m = round_modes.begin(); m != round_modes.end(); ++m) {
-			auto b = d(a, *m);
-			REQUIRE( b.round_mode() == *m );
+			REQUIRE_NOTHROW( d(a, *m) );
 		}
 	}
 }
@@ -270,9 +318,7 @@ TEST_CASE( "Constructors: strings", "[constructors][strings]" ) {
 			auto l = dist(gen);
 			const char * a = to_string(l).c_str();
 			auto A = d(a);
-			REQUIRE( A.errors() == IDecimal::Error::None );
 			REQUIRE( static_cast<int64_t>(A) == l);
-			REQUIRE( A.round_mode() == IDecimal::Round::NearestEven );
 
 			if (strcmp(a, "0") == 0) {
 				REQUIRE( A.is_zero() );
@@ -289,8 +335,7 @@ TEST_CASE( "Constructors: strings", "[constructors][strings]" ) {
 			}
 
 			for (auto m = round_modes.begin(); m != round_modes.end(); ++m) {
-				auto b = d(a, *m);
-				REQUIRE( b.round_mode() == *m );
+				REQUIRE( d(a, *m) == A );
 			}
 		}
 	}	
@@ -302,9 +347,7 @@ TEST_CASE( "Constructors: strings", "[constructors][strings]" ) {
 			auto l = dist(gen);
 			std::string a = to_string(l);
 			auto A = d(a);
-			REQUIRE( A.errors() == IDecimal::Error::None );
 			REQUIRE( static_cast<int64_t>(A) == l);
-			REQUIRE( A.round_mode() == IDecimal::Round::NearestEven );
 
 			if (a == "0") {
 				REQUIRE( A.is_zero() );
@@ -321,8 +364,7 @@ TEST_CASE( "Constructors: strings", "[constructors][strings]" ) {
 			}
 
 			for (auto m = round_modes.begin(); m != round_modes.end(); ++m) {
-				auto b = d(a, *m);
-				REQUIRE( b.round_mode() == *m );
+				REQUIRE( d(a, *m) == A );
 			}
 		}
 	}	
@@ -340,8 +382,6 @@ TEST_CASE( "Assignment operator", "[assignment operator]" ) {
 	REQUIRE( static_cast<int64_t>(A) == static_cast<int64_t>(B) );
 	REQUIRE( A.is_negative() == B.is_negative() );
 	REQUIRE( A.is_normal() == B.is_normal() );
-	REQUIRE( A.round_mode() == B.round_mode() );
-	REQUIRE( A.throw_on_err() == B.throw_on_err() );
 
 	for (int i=0; i < LOOP_SIZE; ++i) {
 		auto a = dist(gen);
@@ -351,8 +391,6 @@ TEST_CASE( "Assignment operator", "[assignment operator]" ) {
 		REQUIRE( static_cast<int64_t>(A) == static_cast<int64_t>(B) );
 		REQUIRE( A.is_negative() == B.is_negative() );
 		REQUIRE( A.is_normal() == B.is_normal() );
-		REQUIRE( A.round_mode() == B.round_mode() );
-		REQUIRE( A.throw_on_err() == B.throw_on_err() );
 	}
 }
 
@@ -383,10 +421,11 @@ TEMPLATE_TEST_CASE( "Floating conversions", "[conversions][floating]", float, do
 		try {
 			TestType a = dist(gen);
 			auto A = d(a);
-			A.throw_on(IDecimal::Error::Inexact);
+			IDecimal::LocalContext local;
+			local->throw_on(IDecimal::Error::Inexact);
 			auto b = static_cast<TestType>(A);
 			REQUIRE( a == b );
-		} catch (IDecimal::InexactException) {
+		} catch (const IDecimal::InexactException &) {
 			continue;
 		}
 	}
@@ -460,8 +499,10 @@ TEST_CASE("String Conversion", "[conversions][strings]") {
 				continue;
 			}
 			
+			IDecimal::LocalContext local;
+			local->clear();
 			auto A = d(num) / d(denom);
-			if (A.overflow() || A.underflow()) {
+			if (local->overflow() || local->underflow()) {
 				continue;
 			}
 			
@@ -473,10 +514,10 @@ TEST_CASE("String Conversion", "[conversions][strings]") {
 
 			// can we convert decimal::str to double?
 			try {
-				B.throw_on(IDecimal::Error::Inexact);
+				local->throw_on(IDecimal::Error::Inexact);
 				auto b = static_cast<double>(B);
 				REQUIRE( b == std::stod(B.str()) );
-			} catch (IDecimal::InexactException) {
+			} catch (const IDecimal::InexactException &) {
 				continue;
 			}
 		}
@@ -545,8 +586,10 @@ TEST_CASE("Scientific notation", "[conversions][sci]") {
 				continue;
 			}
 			
+			IDecimal::LocalContext local;
+			local->clear();
 			auto A = d(num) / d(denom);
-			if (A.overflow() || A.underflow()) {
+			if (local->overflow() || local->underflow()) {
 				continue;
 			}
 			
@@ -558,10 +601,10 @@ TEST_CASE("Scientific notation", "[conversions][sci]") {
 
 			// can we convert decimal::str to double?
 			try {
-				B.throw_on(IDecimal::Error::Inexact);
+				local->throw_on(IDecimal::Error::Inexact);
 				auto b = static_cast<double>(B);
 				REQUIRE( b == std::stod(B.sci()) );
-			} catch (IDecimal::InexactException) {
+			} catch (const IDecimal::InexactException &) {
 				continue;
 			}
 		}
@@ -822,64 +865,71 @@ TEST_CASE( "Exceptions: Invalid", "[invalid]" ) {
 TEST_CASE( "Exceptions: Divide by Zero", "[zerodivide]" ) {
 	auto one = longDecimal::One;
 	auto zero = longDecimal::Zero;
+	IDecimal::LocalContext local;
 	
 	REQUIRE_THROWS_AS( one / zero, LongDecimal::DivideByZeroException);
 	
-	one.throw_off(LongDecimal::Error::DivideByZero);
-	REQUIRE_THROWS_AS( one / zero, LongDecimal::DivideByZeroException);
-	
-	zero.throw_off(LongDecimal::Error::DivideByZero);
+	local->throw_off(LongDecimal::Error::DivideByZero);
+	local->clear();
 	auto res = one / zero;
 	REQUIRE( res == longDecimal::Inf);
-	REQUIRE( res.errors() == d::Error::DivideByZero); 
+	REQUIRE( local->divide_by_zero() );
+	REQUIRE( local->errors == d::Error::DivideByZero); 
+
+	local->throw_on(LongDecimal::Error::DivideByZero);
+	REQUIRE_THROWS_AS( one / zero, LongDecimal::DivideByZeroException);
 }
 
 TEST_CASE( "Exceptions: Overflow / Underflow", "[overflow]" ) {
-	auto one = longDecimal::One;
-	auto zero = longDecimal::Zero;
 	auto max = longDecimal::Max;
 	auto smallest = longDecimal::SmallestPositive;
+	IDecimal::LocalContext local;
 	
 	SECTION("Overflow") {
 		REQUIRE_THROWS_AS( max + max, LongDecimal::OverflowException );
 		
-		max.throw_off(LongDecimal::Error::Overflow );
+		local->throw_off(LongDecimal::Error::Overflow );
 		REQUIRE_NOTHROW( max + max );
 
+		local->clear();
 		auto res = max + max;
-		REQUIRE( res.overflow() );
-		REQUIRE( res.errors() == (d::Error::Overflow | d::Error::Inexact) ); 
+		REQUIRE( res == longDecimal::Inf );
+		REQUIRE( local->overflow() );
+		REQUIRE( local->errors == (d::Error::Overflow | d::Error::Inexact) ); 
 	}
 	
 	SECTION("Underflow") {
 		REQUIRE_THROWS_AS( smallest / max, LongDecimal::UnderflowException );
 		
-		smallest.throw_off(LongDecimal::Error::Underflow);
-		max.throw_off(LongDecimal::Error::Underflow);
+		local->throw_off(LongDecimal::Error::Underflow);
 		REQUIRE_NOTHROW( smallest / max );
 
+		local->clear();
 		auto res = smallest / max;
-		REQUIRE( res.underflow() );
-		REQUIRE( res.errors() == (d::Error::Underflow | d::Error::Inexact) ); 
+		REQUIRE( res.is_zero() );
+		REQUIRE( local->underflow() );
+		REQUIRE( local->errors == (d::Error::Underflow | d::Error::Inexact) ); 
 	}
 }
 
 TEST_CASE( "Exceptions: Inexact", "[inexact]" ) {
 	auto a = d(2, LongDecimal::Round::NearestEven);	
 	auto b = d(3, LongDecimal::Round::NearestEven);	
+	IDecimal::LocalContext local;
 
+	local->clear();
 	auto res = a / b;
 	REQUIRE( res == d("0.6666666666666666666666666666666667"));
-	REQUIRE( res.inexact() );
-	REQUIRE( res.errors() == d::Error::Inexact);	
+	REQUIRE( local->inexact() );
+	REQUIRE( local->errors == d::Error::Inexact);	
 	
-	a.throw_on(LongDecimal::Error::Inexact);
+	local->throw_on(LongDecimal::Error::Inexact);
 	REQUIRE_THROWS_AS( a / b, LongDecimal::InexactException );
 	
-	a.throw_off(LongDecimal::Error::Inexact);
+	local->throw_off(LongDecimal::Error::Inexact);
 	REQUIRE_NOTHROW( a / b );
 
-	a.throw_on(LongDecimal::Error::Any);
+	local->throw_on(LongDecimal::Error::Any);
 	REQUIRE_THROWS_AS( a / b, LongDecimal::InexactException );
 }
 
@@ -925,9 +975,1674 @@ TEST_CASE( "Rounding", "[rounding]" ) {
 		REQUIRE( a == d("-10000000000000000000000000000000020"));
 	}
 
-	SECTION( "Mismatched throws by default" ) {
-		auto a = d("10000000000000000000000000000000025", LongDecimal::Round::NearestEven);
-		auto b = d("10000000000000000000000000000000015", LongDecimal::Round::NearestAway);
-		REQUIRE_THROWS_AS( a + b, LongDecimal::MismatchedRoundingException);
+	SECTION( "Context" ) {
+		auto a = d("10000000000000000000000000000000020");
+		auto b = d("5");
+		IDecimal::LocalContext local;
+
+		REQUIRE( a + b == d("10000000000000000000000000000000020") );
+
+		local->round_mode = LongDecimal::Round::NearestAway;
+		REQUIRE( a + b == d("10000000000000000000000000000000030") );
+	}
+}
+
+TEST_CASE( "ShortDecimal", "[short]" ) {
+	typedef ShortDecimal s;
+
+	SECTION("Layout") {
+		REQUIRE( sizeof(ShortDecimal) == sizeof(D64) );
+		REQUIRE( std::is_trivially_copyable<ShortDecimal>::value );
+		static_assert(ShortDecimal::precision == 16, "BID64 has 16 digits");
+		static_assert(ShortDecimal::emax == 369, "BID64 emax");
+		static_assert(ShortDecimal::emin == -398, "BID64 emin");
+	}
+
+	SECTION("Constants") {
+		REQUIRE( shortDecimal::Zero == s(0) );
+		REQUIRE( shortDecimal::One == s(1) );
+		REQUIRE( shortDecimal::Max == s("9999999999999999E+369") );
+		REQUIRE( shortDecimal::Min == s("-9999999999999999E+369") );
+		REQUIRE( shortDecimal::Inf == s("Inf") );
+		REQUIRE( shortDecimal::NaN != s("+NaN") );
+		REQUIRE( shortDecimal::Min < shortDecimal::Zero );
+		REQUIRE( shortDecimal::Max < shortDecimal::Inf );
+	}
+
+	SECTION("Null constructor") {
+		auto a = s();
+		REQUIRE( a.is_zero() );
+		REQUIRE( !a.is_negative() );
+		REQUIRE( a.str() == "+0E+0" );
+	}
+
+	SECTION("Conversions") {
+    	std::mt19937_64 gen(rd());
+		auto int_dist = uniform_int_distribution<int64_t>(-9999999999999999, 9999999999999999);
+		for (int i=0; i < LOOP_SIZE; ++i) {
+			auto a = int_dist(gen);
+			REQUIRE( static_cast<int64_t>(s(a)) == a );
+			REQUIRE( s(a) == s(std::to_string(a)) );
+		}
+
+		REQUIRE( s(0.5) == s("0.5") );
+		REQUIRE( static_cast<double>(s("0.25")) == 0.25 );
+		REQUIRE( s(1234).str() == "+1234E+0" );
+		REQUIRE( s("-1.5").str() == "-15E-1" );
+	}
+
+	SECTION("Rounding") {
+		// a 64-bit integer may need more than 16 digits
+		REQUIRE( s(12345678901234567ULL) == s("1234567890123457E+1") );
+		REQUIRE( s(12345678901234567ULL, IDecimal::Round::TowardZero) == s("1234567890123456E+1") );
+		REQUIRE_THROWS_AS( s(12345678901234567ULL, IDecimal::Round::NearestEven, IDecimal::Error::Any), IDecimal::InexactException );
+
+		REQUIRE( s("12345678901234565", IDecimal::Round::NearestEven) == s("1234567890123456E+1") );
+		REQUIRE( s("12345678901234565", IDecimal::Round::NearestAway) == s("1234567890123457E+1") );
+		REQUIRE( s("-12345678901234565", IDecimal::Round::Downward) == s("-1234567890123457E+1") );
+		REQUIRE( s("-12345678901234565", IDecimal::Round::TowardZero) == s("-1234567890123456E+1") );
+	}
+
+	SECTION("Arithmetic") {
+		REQUIRE( s(2) + s(3) == s(5) );
+		REQUIRE( s(2) - s(3) == s(-1) );
+		REQUIRE( s(2) * s(3) == s(6) );
+		REQUIRE( s(1) / s(10) == s("0.1") );
+		REQUIRE( -s(2) == s(-2) );
+		REQUIRE( abs(s(-2)) == s(2) );
+		REQUIRE( truncate(s("2.5")) == s(2) );
+
+		for (auto & a : random_ld<ShortDecimal>()) {
+			REQUIRE( a + s(0) == a );
+			REQUIRE( a * s(1) == a );
+			REQUIRE( a - a == s(0) );
+		}
+	}
+
+	SECTION("Exceptions") {
+		REQUIRE_THROWS_AS( s(0) / s(0), IDecimal::InvalidException );
+		REQUIRE_THROWS_AS( s(1) / s(0), IDecimal::DivideByZeroException );
+		REQUIRE_THROWS_AS( shortDecimal::Max * s(10), IDecimal::OverflowException );
+		IDecimal::context().clear();
+	}
+}
+
+TEST_CASE( "Decimal32", "[decimal32]" ) {
+	typedef Decimal32 s;
+
+	SECTION("Layout") {
+		REQUIRE( sizeof(Decimal32) == sizeof(D32) );
+		REQUIRE( std::is_trivially_copyable<Decimal32>::value );
+		static_assert(Decimal32::precision == 7, "BID32 has 7 digits");
+		static_assert(Decimal32::emax == 90, "BID32 emax");
+		static_assert(Decimal32::emin == -101, "BID32 emin");
+	}
+
+	SECTION("Constants") {
+		REQUIRE( decimal32::Zero == s(0) );
+		REQUIRE( decimal32::One == s(1) );
+		REQUIRE( decimal32::Max == s("9999999E+90") );
+		REQUIRE( decimal32::Min == s("-9999999E+90") );
+		REQUIRE( decimal32::Inf == s("Inf") );
+		REQUIRE( decimal32::NaN != s("+NaN") );
+		REQUIRE( decimal32::Min < decimal32::Zero );
+	}
+
+	SECTION("Conversions") {
+		REQUIRE( s(1234567).str() == "+1234567E+0" );
+		REQUIRE( s("-0.0125").str() == "-125E-4" );
+		REQUIRE( static_cast<int>(s("-42")) == -42 );
+		REQUIRE( static_cast<double>(s("0.25")) == 0.25 );
+
+		// even a 32-bit integer may need more than 7 digits
+		REQUIRE( s(12345675) == s("1234568E+1") );
+		REQUIRE( s(12345675, IDecimal::Round::TowardZero) == s("1234567E+1") );
+		REQUIRE_THROWS_AS( s(12345675, IDecimal::Round::NearestEven, IDecimal::Error::Any), IDecimal::InexactException );
+	}
+
+	SECTION("Widening") {
+		for (auto a : random_ld<Decimal32>()) {
+			ShortDecimal b = a;
+			LongDecimal c = a;
+			REQUIRE( b == ShortDecimal(a.str()) );
+			REQUIRE( c == LongDecimal(a.str()) );
+		}
+
+		REQUIRE( ShortDecimal(decimal32::Max) == ShortDecimal("9999999E+90") );
+		REQUIRE( LongDecimal(decimal32::SmallestNegative) == LongDecimal("-9999999E-101") );
+		REQUIRE( LongDecimal(decimal32::Inf) == longDecimal::Inf );
+
+		// arithmetic on mixed widths is done in the wider one
+		REQUIRE( ShortDecimal("0.0001") + s("0.5") == ShortDecimal("0.5001") );
+		REQUIRE( s("1.5") * ShortDecimal("2") == ShortDecimal(3) );
+	}
+}
+
+TEST_CASE( "Width conversions", "[conversions][widths]" ) {
+	SECTION("Widening") {
+		for (auto a : random_ld<ShortDecimal>()) {
+			LongDecimal b = a;
+			REQUIRE( b == LongDecimal(a.str()) );
+			REQUIRE( ShortDecimal(b) == a );
+		}
+	}
+
+	SECTION("Narrowing") {
+		auto a = LongDecimal("12345678901234565");
+		REQUIRE( ShortDecimal(a) == ShortDecimal("1234567890123456E+1") );
+		REQUIRE( ShortDecimal(a, IDecimal::Round::NearestAway) == ShortDecimal("1234567890123457E+1") );
+		REQUIRE( Decimal32(a, IDecimal::Round::TowardZero) == Decimal32("1234567E+10") );
+		REQUIRE( Decimal32(ShortDecimal("0.5")) == Decimal32("0.5") );
+
+		REQUIRE_THROWS_AS( ShortDecimal(a, IDecimal::Round::NearestEven, IDecimal::Error::Any), IDecimal::InexactException );
+		REQUIRE_THROWS_AS( ShortDecimal(longDecimal::Max), IDecimal::OverflowException );
+		REQUIRE_THROWS_AS( Decimal32(shortDecimal::Max), IDecimal::OverflowException );
+	}
+
+	SECTION("Flags") {
+		ErrorFlags flags = IDecimal::Error::None;
+		auto a = ShortDecimal::convert(LongDecimal("0.125"), IDecimal::Round::NearestEven, &flags);
+		REQUIRE( a == ShortDecimal("0.125") );
+		REQUIRE( flags == IDecimal::Error::None );
+
+		auto b = Decimal32::convert(LongDecimal("1.234567891"), IDecimal::Round::Upward, &flags);
+		REQUIRE( b == Decimal32("1.234568") );
+		REQUIRE( flags == IDecimal::Error::Inexact );
+
+		REQUIRE_NOTHROW( ShortDecimal::convert(longDecimal::Max, IDecimal::Round::NearestEven, &flags) );
+		REQUIRE( (flags & IDecimal::Error::Overflow) == IDecimal::Error::Overflow );
+	}
+
+	SECTION("Columns") {
+		auto a = random_ld<ShortDecimal>();
+		vector<LongDecimal> b(a.size());
+		vector<ShortDecimal> c(a.size());
+		ErrorFlags flags = IDecimal::Error::None;
+
+		LongDecimal::convert<ShortDecimal>(a, b, IDecimal::Round::NearestEven, &flags);
+		ShortDecimal::convert<LongDecimal>(b, c, IDecimal::Round::NearestEven, &flags);
+		REQUIRE( flags == IDecimal::Error::None );
+		for (size_t i = 0; i < a.size(); ++i) {
+			REQUIRE( b[i] == LongDecimal(a[i]) );
+			REQUIRE( c[i] == a[i] );
+		}
+
+		vector<LongDecimal> wide = { LongDecimal(1), LongDecimal("1.00000001"), LongDecimal(3) };
+		vector<Decimal32> narrow(wide.size());
+		Decimal32::convert<LongDecimal>(wide, narrow, IDecimal::Round::NearestEven, &flags);
+		REQUIRE( narrow[1] == Decimal32(1) );
+		REQUIRE( narrow[2] == Decimal32(3) );
+		REQUIRE( flags == IDecimal::Error::Inexact );
+	}
+}
+
+TEST_CASE( "Context", "[context]" ) {
+	auto a = d("10000000000000000000000000000000020");
+	auto b = d("5");
+
+	SECTION("Local context") {
+		{
+			IDecimal::LocalContext local;
+			local->round_mode = IDecimal::Round::NearestAway;
+			local->throw_on(IDecimal::Error::Inexact);
+			REQUIRE_THROWS_AS( a + b, IDecimal::InexactException );
+			REQUIRE( local->inexact() );
+		}
+
+		// everything is restored when the guard goes out of scope
+		auto & context = IDecimal::context();
+		REQUIRE( context.round_mode == IDecimal::Round::NearestEven );
+		REQUIRE( context.throw_on_err == IDecimal::Error::Undefined );
+		REQUIRE( !context.inexact() );
+		REQUIRE( a + b == d("10000000000000000000000000000000020") );
+	}
+
+	SECTION("Installed context") {
+		IDecimal::Context upward;
+		upward.round_mode = IDecimal::Round::Upward;
+
+		IDecimal::LocalContext local(upward);
+		REQUIRE( a + b == d("10000000000000000000000000000000030") );
+		REQUIRE( local->inexact() );
+		REQUIRE( !upward.inexact() );
+	}
+
+	SECTION("Sticky flags") {
+		IDecimal::LocalContext local;
+		local->clear();
+		REQUIRE( a + d(10) == d("10000000000000000000000000000000030") );
+		REQUIRE( !local->inexact() );
+		REQUIRE( a + b == a );
+		REQUIRE( a + d(10) == d("10000000000000000000000000000000030") );
+		REQUIRE( local->inexact() );
+	}
+
+	SECTION("Threads") {
+		IDecimal::LocalContext local;
+		local->round_mode = IDecimal::Round::TowardZero;
+		local->clear();
+
+		// another thread starts from the default context,
+		// and its errors are not seen here
+		d c;
+		std::thread t([&]() { c = a + d(6); });
+		t.join();
+
+		REQUIRE( c == d("10000000000000000000000000000000030") );
+		REQUIRE( !local->inexact() );
+		REQUIRE( a + d(6) == d("10000000000000000000000000000000020") );
+		REQUIRE( local->inexact() );
+	}
+
+	SECTION("Constructors") {
+		IDecimal::LocalContext local;
+		local->round_mode = IDecimal::Round::TowardZero;
+		local->clear();
+
+		// constructors round with the context's mode and save their errors there
+		REQUIRE( d("1.999999999999999999999999999999999999") == d("1.999999999999999999999999999999999") );
+		REQUIRE( d(1.0 / 3.0) < d("0.3333333333333333148296162562473910") );
+		REQUIRE( local->errors == IDecimal::Error::Inexact );
+
+		local->clear();
+		REQUIRE( ShortDecimal(d("1.999999999999999999")) == ShortDecimal("1.999999999999999") );
+		REQUIRE( Decimal32(d(-12345678)) == Decimal32("-1.234567E+7") );
+		REQUIRE( local->errors == IDecimal::Error::Inexact );
+
+		// and throw on the errors the context traps
+		local->throw_on(IDecimal::Error::Inexact);
+		REQUIRE_THROWS_AS( d("1.999999999999999999999999999999999999"), IDecimal::InexactException );
+		REQUIRE_THROWS_AS( ShortDecimal(d("1.999999999999999999")), IDecimal::InexactException );
+		REQUIRE_NOTHROW( ShortDecimal(d("1.5")) );
+
+		local->throw_off(IDecimal::Error::Inexact);
+		local->throw_on(IDecimal::Error::Overflow);
+		REQUIRE_THROWS_AS( Decimal32(longDecimal::Max), IDecimal::OverflowException );
+	}
+}
+
+TEST_CASE( "Non-throwing arithmetic", "[nothrow]" ) {
+	auto round_mode = IDecimal::Round::NearestEven;
+	static_assert(noexcept(add(std::declval<d>(), std::declval<d>(), round_mode, nullptr)), "add must not throw");
+	static_assert(noexcept(div(std::declval<ShortDecimal>(), std::declval<ShortDecimal>(), round_mode, nullptr)), "div must not throw");
+
+	SECTION("Sanity Check") {
+		ErrorFlags flags = IDecimal::Error::None;
+		REQUIRE( add(d(2), d(3), round_mode, &flags) == d(5) );
+		REQUIRE( sub(d(2), d(3), round_mode, &flags) == d(-1) );
+		REQUIRE( mul(d(2), d(3), round_mode, &flags) == d(6) );
+		REQUIRE( div(d(1), d(10), round_mode, &flags) == d("0.1") );
+		REQUIRE( flags == IDecimal::Error::None );
+	}
+
+	SECTION("Flags") {
+		IDecimal::LocalContext local;
+		local->throw_on(IDecimal::Error::Inexact);
+		local->clear();
+
+		ErrorFlags flags = IDecimal::Error::None;
+		REQUIRE( div(d(1), d(3), IDecimal::Round::Upward, &flags) == d("0.3333333333333333333333333333333334") );
+		REQUIRE( flags == IDecimal::Error::Inexact );
+
+		auto a = div(d(1), d(0), round_mode, &flags);
+		REQUIRE( a == longDecimal::Inf );
+		REQUIRE( (flags & IDecimal::Error::DivideByZero) == IDecimal::Error::DivideByZero );
+
+		// an invalid operation gives NaN
+		auto b = div(d(0), d(0), round_mode, &flags);
+		REQUIRE( b != b );
+		REQUIRE( (flags & IDecimal::Error::Invalid) == IDecimal::Error::Invalid );
+
+		// the context is left alone
+		REQUIRE( local->errors == IDecimal::Error::None );
+	}
+
+	SECTION("Random") {
+		// the operators must not throw either, so they can be compared
+		IDecimal::LocalContext local;
+		local->throw_on_err = IDecimal::Error::Invalid;
+
+		ErrorFlags flags = IDecimal::Error::None;
+		auto a = A();
+		auto b = B();
+		for (int i = 0; i < LOOP_SIZE; ++i) {
+			REQUIRE( add(a[i], b[i], round_mode, &flags) == a[i] + b[i] );
+			REQUIRE( mul(a[i], b[i], round_mode, &flags) == a[i] * b[i] );
+		}
+	}
+}
+
+TEST_CASE( "Static policies", "[policies]" ) {
+	typedef BasicDecimal<D128, IDecimal::Round::TowardZero> fee;
+	typedef BasicDecimal<D64, IDecimal::Round::NearestAway, IDecimal::Error::Undefined | IDecimal::Error::Inexact> strict;
+
+	REQUIRE( sizeof(fee) == sizeof(D128) );
+	REQUIRE( sizeof(strict) == sizeof(D64) );
+	REQUIRE( std::is_trivially_copyable<fee>::value );
+
+	// the context is neither read nor written
+	IDecimal::LocalContext local;
+	local->round_mode = IDecimal::Round::Upward;
+	local->throw_on(IDecimal::Error::Inexact);
+	local->clear();
+
+	SECTION("Rounding") {
+		REQUIRE( fee(2) / fee(3) == fee("0.6666666666666666666666666666666666") );
+		REQUIRE( -fee(2) / fee(3) == fee("-0.6666666666666666666666666666666666") );
+		REQUIRE( fee("10000000000000000000000000000000029") == fee("10000000000000000000000000000000020") );
+		REQUIRE( local->errors == IDecimal::Error::None );
+	}
+
+	SECTION("Traps") {
+		REQUIRE( strict(3) * strict(5) == strict(15) );
+		REQUIRE_THROWS_AS( strict(2) / strict(3), IDecimal::InexactException );
+		REQUIRE_THROWS_AS( strict("12345678901234565"), IDecimal::InexactException );
+		REQUIRE_THROWS_AS( strict(1) / strict(0), IDecimal::DivideByZeroException );
+		REQUIRE( local->errors == IDecimal::Error::None );
+	}
+
+	SECTION("Conversions") {
+		// between policies of the same width
+		auto a = fee(LongDecimal("1.5"));
+		REQUIRE( LongDecimal(a) == LongDecimal("1.5") );
+		REQUIRE( LongDecimal(fee(2) / fee(3)) == LongDecimal("0.6666666666666666666666666666666666") );
+
+		// between widths
+		REQUIRE( strict(fee("2.5")) == strict("2.5") );
+		REQUIRE( fee(strict("2.5")) == fee("2.5") );
+
+		// 0.1 has no exact binary representation, so it is rounded toward zero
+		REQUIRE( static_cast<double>(fee("0.1")) < 0.1 );
+	}
+}
+
+// builds a BID128 value from its parts
+static D128 bid128(const bool negative, const int exponent, const unsigned __int128 coefficient) {
+	D128 x;
+	x.w[0] = static_cast<uint64_t>(coefficient);
+	x.w[1] = (negative? bid_traits<D128>::sign_mask : 0) 
+		| (static_cast<uint64_t>(exponent + 6176) << 49) 
+		| static_cast<uint64_t>(coefficient >> 64);
+	return x;
+}
+
+// a random coefficient of up to max_digits digits (at most 38);
+// the number of digits is drawn first, so short coefficients are as common as long ones
+static unsigned __int128 random_coefficient(std::mt19937_64 & gen, const int max_digits) {
+	const int digits = uniform_int_distribution<int>(0, max_digits)(gen);
+	const unsigned __int128 bits = (static_cast<unsigned __int128>(gen()) << 64) | gen();
+	return bits % pow10_128[digits];
+}
+
+// calls an operation and libbid's version of it with the same arguments;
+// the results must match bit for bit, flags included
+template <class F, class G, class... Args>
+static void require_same(F op, G expected_op, const Args... args) {
+	ErrorFlags flags = IDecimal::Error::None, expected_flags = IDecimal::Error::None;
+	const auto result = op(args..., &flags);
+	const auto expected = expected_op(args..., &expected_flags);
+	REQUIRE( memcmp(&result, &expected, sizeof(result)) == 0 );
+	REQUIRE( flags == expected_flags );
+}
+
+TEST_CASE( "Fast paths: BID128 addition", "[fastpath][add]" ) {
+	typedef bid_traits<D128> bid;
+	std::mt19937_64 gen(rd());
+	auto sign_dist = std::bernoulli_distribution(0.5);
+	auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+
+	// the fast path is taken inside bid::add and bid::sub
+	auto require_same_sums = [](const D128 x, const D128 y, const RoundMode round_mode) {
+		require_same(bid::add, bid128_add, x, y, round_mode);
+		require_same(bid::sub, bid128_sub, x, y, round_mode);
+	};
+
+	SECTION("Same exponent") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			auto exponent = exponent_dist(gen);
+			auto x = bid128(sign_dist(gen), exponent, random_coefficient(gen, 34));
+			auto y = bid128(sign_dist(gen), exponent, random_coefficient(gen, 34));
+			for (auto m : round_modes) {
+				require_same_sums(x, y, m);
+			}
+		}
+	}
+
+	SECTION("Edge cases") {
+		const unsigned __int128 max = bid::coefficient_limit - 1;
+		vector<D128> v = {
+			bid128(false, 0, 0), bid128(true, 0, 0), bid128(false, -2, 0), bid128(true, -2, 0),
+			bid128(false, 0, 1), bid128(true, 0, 1), bid128(false, -2, 150), bid128(true, -2, 150),
+			bid128(false, 0, max), bid128(true, 0, max), bid128(false, 6111, max), bid128(true, -6176, 1),
+			bid128(false, 0, bid::coefficient_limit), // non-canonical
+			D128{{0, 0x7800000000000000ull}}, D128{{0, 0xf800000000000000ull}}, // infinities
+			D128{{0, 0x7c00000000000000ull}}, D128{{0, 0x7e00000000000000ull}} // NaNs
+		};
+
+		for (auto x : v) {
+			for (auto y : v) {
+				for (auto m : round_modes) {
+					require_same_sums(x, y, m);
+				}
+			}
+		}
+	}
+
+	SECTION("Operators") {
+		auto a = d("1.25");
+		REQUIRE( a + d("2.50") == d("3.75") );
+
+		auto b = a - a;
+		REQUIRE( b.str() == "+0E-2" );
+
+		IDecimal::LocalContext local;
+		local->round_mode = IDecimal::Round::Downward;
+		b = a - a;
+		REQUIRE( b.str() == "-0E-2" );
+	}
+}
+
+TEST_CASE( "Fast paths: BID128 multiplication", "[fastpath][mul]" ) {
+	typedef bid_traits<D128> bid;
+	std::mt19937_64 gen(rd());
+	auto sign_dist = std::bernoulli_distribution(0.5);
+	auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+	auto small_exponent_dist = uniform_int_distribution<int>(-20, 20);
+
+	// coefficients of up to 20 digits, most of which fit in 64 bits
+	auto coefficient = [&]() { return random_coefficient(gen, 20); };
+
+	SECTION("Random") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			auto x = bid128(sign_dist(gen), small_exponent_dist(gen), coefficient());
+			auto y = bid128(sign_dist(gen), small_exponent_dist(gen), coefficient());
+			auto u = bid128(sign_dist(gen), exponent_dist(gen), coefficient());
+			auto v = bid128(sign_dist(gen), exponent_dist(gen), coefficient());
+			for (auto m : round_modes) {
+				require_same(bid::mul, bid128_mul, x, y, m);
+				require_same(bid::mul, bid128_mul, u, v, m);
+			}
+		}
+	}
+
+	SECTION("Edge cases") {
+		const unsigned __int128 max64 = numeric_limits<uint64_t>::max();
+		vector<D128> v = {
+			bid128(false, 0, 0), bid128(true, 0, 0), bid128(false, -6176, 0), bid128(true, 6111, 0),
+			bid128(false, 0, 1), bid128(true, -2, 150), bid128(false, 3000, 7), bid128(true, -3100, 9),
+			bid128(false, 0, max64), bid128(true, -6176, max64), bid128(false, 6111, max64),
+			bid128(false, 0, max64 + 1), bid128(false, 0, bid::coefficient_limit - 1),
+			bid128(false, 0, 9999999999999999ull), bid128(false, 0, 100000000000000000ull), 
+			D128{{0, 0x7800000000000000ull}}, D128{{0, 0xf800000000000000ull}}, // infinities
+			D128{{0, 0x7c00000000000000ull}}, D128{{0, 0x7e00000000000000ull}} // NaNs
+		};
+
+		for (auto x : v) {
+			for (auto y : v) {
+				for (auto m : round_modes) {
+					require_same(bid::mul, bid128_mul, x, y, m);
+				}
+			}
+		}
+	}
+
+	SECTION("Operators") {
+		auto price = d("101.25");
+		auto quantity = d(300);
+		REQUIRE( price * quantity == d("30375.00") );
+		REQUIRE( -price * quantity == d("-30375") );
+	}
+}
+
+static constexpr D64 bid64(const bool negative, const int exponent, const uint64_t coefficient) {
+	// the encoding (plain or steering form) depends on the size of the coefficient
+	const uint64_t sign = negative? bid64_engine::sign_mask : 0;
+	const uint64_t e = static_cast<uint64_t>(exponent + 398);
+	if (coefficient < (1ull << 53)) {
+		return sign | (e << 53) | coefficient;
+	}
+	return sign | bid64_engine::steering_mask | (e << 51) | (coefficient & bid64_engine::large_coefficient_mask);
+}
+
+TEST_CASE( "Native BID64 engine", "[engine]" ) {
+	typedef bid64_engine engine;
+	std::mt19937_64 gen(rd());
+	auto sign_dist = std::bernoulli_distribution(0.5);
+	auto exponent_dist = uniform_int_distribution<int>(-398, 369);
+	auto small_exponent_dist = uniform_int_distribution<int>(-20, 20);
+	auto word_dist = uniform_int_distribution<uint64_t>();
+
+	auto coefficient = [&]() { return static_cast<uint64_t>(random_coefficient(gen, 16)); };
+
+	auto require_same_ops = [](const D64 x, const D64 y, const RoundMode round_mode) {
+		require_same(engine::add, bid64_add, x, y, round_mode);
+		require_same(engine::sub, bid64_sub, x, y, round_mode);
+		require_same(engine::mul, bid64_mul, x, y, round_mode);
+		require_same(engine::div, bid64_div, x, y, round_mode);
+		require_same(engine::quiet_equal, bid64_quiet_equal, x, y);
+		require_same(engine::quiet_less, bid64_quiet_less, x, y);
+
+		// a NaN result is only required to be a NaN here, whatever its payload
+		ErrorFlags flags = IDecimal::Error::None, expected_flags = IDecimal::Error::None;
+		auto same = [](const D64 a, const D64 b) {
+			return a == b || (engine::is_nan(a) && engine::is_nan(b) && !engine::is_snan(a) && !engine::is_snan(b));
+		};
+		REQUIRE( same(engine::quantize(x, y, round_mode, &flags), bid64_quantize(x, y, round_mode, &expected_flags)) );
+		REQUIRE( same(engine::round_integral_exact(x, round_mode, &flags), bid64_round_integral_exact(x, round_mode, &expected_flags)) );
+		REQUIRE( same(engine::round_integral_zero(x, &flags), bid64_round_integral_zero(x, &expected_flags)) );
+		REQUIRE( flags == expected_flags );
+	};
+
+	SECTION("Random values") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			auto x = bid64(sign_dist(gen), small_exponent_dist(gen), coefficient());
+			auto y = bid64(sign_dist(gen), small_exponent_dist(gen), coefficient());
+			auto u = bid64(sign_dist(gen), exponent_dist(gen), coefficient());
+			auto v = bid64(sign_dist(gen), exponent_dist(gen), coefficient());
+			for (auto m : round_modes) {
+				require_same_ops(x, y, m);
+				require_same_ops(u, v, m);
+				require_same_ops(x, v, m);
+			}
+		}
+	}
+
+	SECTION("Random bits") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			auto x = word_dist(gen);
+			auto y = word_dist(gen);
+			for (auto m : round_modes) {
+				require_same_ops(x, y, m);
+			}
+		}
+	}
+
+	SECTION("Edge cases") {
+		const uint64_t max = engine::coefficient_limit - 1;
+		vector<D64> v = {
+			bid64(false, 0, 0), bid64(true, 0, 0), bid64(false, -2, 0), bid64(true, -398, 0), bid64(false, 369, 0),
+			bid64(false, 0, 1), bid64(true, 0, 1), bid64(false, -2, 150), bid64(true, -2, 5), bid64(false, -1, 25),
+			bid64(false, 0, 3), bid64(false, 0, 7), bid64(true, -1, 15), bid64(false, -3, 2500),
+			bid64(false, 0, max), bid64(true, 0, max), bid64(false, 369, max), bid64(true, 369, 1),
+			bid64(false, -398, 1), bid64(true, -398, max), bid64(false, -383, 1), bid64(false, -398, 1000000000000000ull),
+			bid64(false, 0, 9007199254740992ull), // the smallest coefficient in the steering form
+			bid64(false, 0, engine::coefficient_limit), // non-canonical
+			0x7800000000000000ull, 0xf800000000000000ull, // infinities
+			0x7c00000000000000ull, 0xfc00000000000005ull, 0x7e00000000000003ull // NaNs
+		};
+
+		for (auto x : v) {
+			for (auto y : v) {
+				for (auto m : round_modes) {
+					require_same_ops(x, y, m);
+				}
+			}
+		}
+	}
+
+	SECTION("Constant expressions") {
+		constexpr auto sum = []() {
+			ErrorFlags flags = 0;
+			return engine::add(bid64(false, -2, 125), bid64(false, -2, 250), 0, &flags);
+		}();
+		static_assert(sum == bid64(false, -2, 375));
+
+		constexpr auto third = []() {
+			ErrorFlags flags = 0;
+			return engine::div(bid64(false, 0, 1), bid64(false, 0, 3), 0, &flags);
+		}();
+		static_assert(third == bid64(false, -16, 3333333333333333ull));
+	}
+
+	SECTION("Operators") {
+		typedef ShortDecimal s;
+		REQUIRE( s("1.25") + s("2.50") == s("3.75") );
+		REQUIRE( s("101.25") * s(300) == s("30375") );
+		REQUIRE( s(1) / s(4) == s("0.25") );
+
+		auto q = quantize(s("2.345"), s("0.01"));
+		REQUIRE( q.str() == "+234E-2" );
+		REQUIRE_THROWS_AS( quantize(s("1E+20"), s("0.01")), IDecimal::InvalidException );
+	}
+}
+
+TEST_CASE( "Literals", "[literals]" ) {
+	using namespace decimal754::literals;
+
+	// a literal must encode exactly what the string constructor does
+	auto require_parsed = [](const auto literal, const char * s) {
+		typedef std::remove_const_t<decltype(literal)> decimal;
+		REQUIRE( literal.bits() == decimal(s).bits() );
+	};
+
+	SECTION("LongDecimal") {
+		require_parsed(0.01_d128, "0.01");
+		require_parsed(0_d128, "0");
+		require_parsed(0.000_d128, "0.000");
+		require_parsed(100_d128, "100");
+		require_parsed(1'000.25_d128, "1000.25");
+		require_parsed(1.5e-3_d128, "1.5E-3");
+		require_parsed(12E+40_d128, "12E+40");
+		require_parsed(3.1415926535897932384626433832795028841971_d128, "3.1415926535897932384626433832795028841971");
+		require_parsed(9999999999999999999999999999999999.5_d128, "9999999999999999999999999999999999.5");
+		require_parsed(9999999999999999999999999999999999E6111_d128, "9999999999999999999999999999999999E6111");
+		require_parsed(1E6144_d128, "1E6144");
+		require_parsed(1E-6176_d128, "1E-6176");
+		require_parsed(0E-9000_d128, "0E-9000");
+		require_parsed("-0.0025"_d128, "-0.0025");
+		require_parsed("+7"_d128, "+7");
+		require_parsed("-0"_d128, "-0");
+		require_parsed("Inf"_d128, "Inf");
+		require_parsed("-Inf"_d128, "-Inf");
+		require_parsed("NaN"_d128, "NaN");
+	}
+
+	SECTION("ShortDecimal") {
+		require_parsed(0.01_d64, "0.01");
+		require_parsed(101.25_d64, "101.25");
+		require_parsed(1234567890123456789_d64, "1234567890123456789");
+		require_parsed(0.12345678901234565_d64, "0.12345678901234565");
+		require_parsed(0.12345678901234575_d64, "0.12345678901234575");
+		require_parsed(0.123456789012345650000000000000000000000001_d64, "0.123456789012345650000000000000000000000001");
+		require_parsed(9999999999999999.5_d64, "9999999999999999.5");
+		require_parsed(9007199254740993_d64, "9007199254740993");
+		require_parsed(1E384_d64, "1E384");
+		require_parsed(1E-398_d64, "1E-398");
+		require_parsed("-1.5"_d64, "-1.5");
+		require_parsed("-Inf"_d64, "-Inf");
+		require_parsed("NaN"_d64, "NaN");
+	}
+
+	SECTION("Decimal32") {
+		require_parsed(0.05_d32, "0.05");
+		require_parsed(9999999_d32, "9999999");
+		require_parsed(8388608_d32, "8388608");
+		require_parsed(12345678_d32, "12345678");
+		require_parsed(1E-101_d32, "1E-101");
+		require_parsed(1E96_d32, "1E96");
+		require_parsed("-12.5"_d32, "-12.5");
+		require_parsed("Inf"_d32, "Inf");
+	}
+
+	SECTION("Constant expressions") {
+		constexpr auto tick = 0.01_d64;
+		static_assert(tick.bits() == bid64(false, -2, 1));
+		static_assert("-2.50"_d64.bits() == bid64(true, -2, 250));
+		static_assert((5_d128).bits() == D128{{5, 0x3040000000000000ull}});
+		static_assert((0.5_d32).bits() == 0x32000005u);
+		static_assert(sizeof(0.01_d64) == sizeof(D64));
+	}
+}
+
+TEST_CASE( "Three-way comparison", "[comparison]" ) {
+	std::mt19937_64 gen(rd());
+	auto sign_dist = std::bernoulli_distribution(0.5);
+	auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+	auto small_exponent_dist = uniform_int_distribution<int>(-5, 5);
+	auto coefficient = [&]() { return random_coefficient(gen, 34); };
+
+	// the order must agree with libbid's quiet comparisons, flags included
+	auto require_same_order = [](const auto x, const auto y, auto quiet_less, auto quiet_equal) {
+		typedef bid_traits<std::remove_const_t<decltype(x)>> bid;
+		ErrorFlags flags = IDecimal::Error::None, expected_flags = IDecimal::Error::None;
+		const int order = bid::compare(x, y, &flags);
+		const int less = quiet_less(x, y, &expected_flags);
+		const int greater = quiet_less(y, x, &expected_flags);
+		const int equal = quiet_equal(x, y, &expected_flags);
+		const int expected = less? -1 : greater? 1 : equal? 0 : 2;
+		REQUIRE( order == expected );
+		REQUIRE( flags == (expected_flags & IDecimal::Error::Invalid) );
+	};
+
+	SECTION("LongDecimal") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			auto e = small_exponent_dist(gen);
+			auto x = bid128(sign_dist(gen), e, coefficient());
+			auto y = bid128(sign_dist(gen), e + small_exponent_dist(gen), coefficient());
+			auto u = bid128(sign_dist(gen), exponent_dist(gen), coefficient());
+			auto v = bid128(sign_dist(gen), exponent_dist(gen), coefficient());
+			require_same_order(x, y, bid128_quiet_less, bid128_quiet_equal);
+			require_same_order(u, v, bid128_quiet_less, bid128_quiet_equal);
+			require_same_order(x, x, bid128_quiet_less, bid128_quiet_equal);
+		}
+
+		vector<D128> v = {
+			bid128(false, 0, 0), bid128(true, 0, 0), bid128(false, -6176, 0), bid128(true, 6111, 0),
+			bid128(false, 0, 1), bid128(false, -1, 10), bid128(false, -33, pow10_128[33]), bid128(true, 0, 1),
+			bid128(false, 6111, bid_traits<D128>::coefficient_limit - 1), bid128(false, -6176, 1),
+			bid128(false, 0, bid_traits<D128>::coefficient_limit), // non-canonical
+			D128{{1, 0x6000000000000000ull}}, // non-canonical steering form
+			D128{{0, 0x7800000000000000ull}}, D128{{0, 0xf800000000000000ull}}, // infinities
+			D128{{0, 0x7c00000000000000ull}}, D128{{0, 0x7e00000000000000ull}} // NaNs
+		};
+		for (auto x : v) {
+			for (auto y : v) {
+				require_same_order(x, y, bid128_quiet_less, bid128_quiet_equal);
+			}
+		}
+	}
+
+	SECTION("Decimal32") {
+		vector<D32> v = {
+			0x32800000u, 0xb2800000u, 0x32800001u, 0x3200000au, 0xb2800001u, 0x328f423fu, // 0, -0, 1, 1.0, -1, 999999
+			0x6cb8967fu, 0x00000001u, 0x77f8967fu, 0x6cb89680u, // 9999999, the smallest, the largest, non-canonical
+			0x78000000u, 0xf8000000u, 0x7c000000u, 0x7e000000u
+		};
+		for (auto x : v) {
+			for (auto y : v) {
+				require_same_order(x, y, bid32_quiet_less, bid32_quiet_equal);
+			}
+		}
+	}
+
+	SECTION("Operators") {
+		auto one = d(1);
+		auto cohort = d("1.00");
+		auto two = d(2);
+		auto nan = longDecimal::NaN;
+
+		REQUIRE( (one <=> cohort) == std::partial_ordering::equivalent );
+		REQUIRE( (one <=> two) == std::partial_ordering::less );
+		REQUIRE( (two <=> one) == std::partial_ordering::greater );
+		REQUIRE( (one <=> nan) == std::partial_ordering::unordered );
+
+		REQUIRE( one < two );
+		REQUIRE( !(one > two) );
+		REQUIRE( !(one > cohort) );
+		REQUIRE( one >= cohort );
+		REQUIRE( one <= cohort );
+		REQUIRE( two > one );
+		REQUIRE( (!(nan < one) && !(nan > one) && !(nan == nan) && nan != nan) );
+
+		REQUIRE( ShortDecimal("2.5") > ShortDecimal("2.49") );
+		REQUIRE( Decimal32("-0") == Decimal32("0") );
+		REQUIRE( longDecimal::Min < longDecimal::SmallestNegative );
+
+		vector<d> v = { d(3), d("-1.5"), d("2.25"), d(0), d("-7") };
+		std::sort(v.begin(), v.end());
+		REQUIRE( std::is_sorted(v.begin(), v.end()) );
+		REQUIRE( v.front() == d(-7) );
+	}
+}
+
+TEST_CASE( "Classification", "[classification]" ) {
+	std::mt19937_64 gen(rd());
+	auto word_dist = uniform_int_distribution<uint64_t>();
+	auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+
+	// every predicate must agree with libbid
+	auto require_same_128 = [](const D128 x) {
+		typedef bid_traits<D128> bid;
+		REQUIRE( bid::is_signed(x) == bid128_isSigned(x) );
+		REQUIRE( bid::is_normal(x) == bid128_isNormal(x) );
+		REQUIRE( bid::is_subnormal(x) == bid128_isSubnormal(x) );
+		REQUIRE( bid::is_zero(x) == bid128_isZero(x) );
+		REQUIRE( bid::is_finite(x) == bid128_isFinite(x) );
+		REQUIRE( bid::is_inf(x) == bid128_isInf(x) );
+		REQUIRE( bid::is_nan(x) == bid128_isNaN(x) );
+		REQUIRE( bid::is_snan(x) == bid128_isSignaling(x) );
+		REQUIRE( bid::is_canonical(x) == bid128_isCanonical(x) );
+		REQUIRE( bid::classify(x) == bid128_class(x) );
+	};
+
+	auto require_same_64 = [](const D64 x) {
+		typedef bid_traits<D64> bid;
+		REQUIRE( bid::is_signed(x) == bid64_isSigned(x) );
+		REQUIRE( bid::is_normal(x) == bid64_isNormal(x) );
+		REQUIRE( bid::is_subnormal(x) == bid64_isSubnormal(x) );
+		REQUIRE( bid::is_zero(x) == bid64_isZero(x) );
+		REQUIRE( bid::is_finite(x) == bid64_isFinite(x) );
+		REQUIRE( bid::is_inf(x) == bid64_isInf(x) );
+		REQUIRE( bid::is_nan(x) == bid64_isNaN(x) );
+		REQUIRE( bid::is_snan(x) == bid64_isSignaling(x) );
+		REQUIRE( bid::is_canonical(x) == bid64_isCanonical(x) );
+		REQUIRE( bid::classify(x) == bid64_class(x) );
+	};
+
+	SECTION("Random bits") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			require_same_128(D128{{word_dist(gen), word_dist(gen)}});
+			require_same_64(word_dist(gen));
+
+			// the top bits decide the class, so they are also tried one by one
+			const uint64_t tops[] = { 0x7800000000000000ull, 0x7c00000000000000ull, 0x7e00000000000000ull, 0x6000000000000000ull };
+			for (auto top : tops) {
+				require_same_128(D128{{word_dist(gen), top | (word_dist(gen) >> 6)}});
+				require_same_64(top | (word_dist(gen) >> 6));
+			}
+		}
+	}
+
+	SECTION("Random values") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			auto c = random_coefficient(gen, 34);
+			require_same_128(bid128(word_dist(gen) & 1, exponent_dist(gen), c));
+			require_same_128(bid128(word_dist(gen) & 1, -6176 + static_cast<int>(word_dist(gen) % 40), c));
+			require_same_64(bid64(word_dist(gen) & 1, -398 + static_cast<int>(word_dist(gen) % 30), 
+				static_cast<uint64_t>(c % 10000000000000000ull)));
+		}
+	}
+
+	SECTION("Decimal32") {
+		typedef bid_traits<D32> bid;
+		REQUIRE( bid::classify(0x32800001u) == IDecimal::Class::PositiveNormal ); // 1
+		REQUIRE( bid::classify(0xb2800000u) == IDecimal::Class::NegativeZero );
+		REQUIRE( bid::classify(0x00000001u) == IDecimal::Class::PositiveSubnormal ); // 1E-101
+		REQUIRE( bid::classify(0x000f4240u) == IDecimal::Class::PositiveNormal ); // 1000000E-101 = 1E-95
+		REQUIRE( bid::classify(0x800f423fu) == IDecimal::Class::NegativeSubnormal ); // -999999E-101
+		REQUIRE( bid::classify(0xf8000000u) == IDecimal::Class::NegativeInfinity );
+		REQUIRE( bid::classify(0x7c000000u) == IDecimal::Class::QuietNaN );
+		REQUIRE( bid::classify(0x7e000000u) == IDecimal::Class::SignalingNaN );
+		REQUIRE( bid::classify(0x6cb89680u) == IDecimal::Class::PositiveZero ); // non-canonical 10^7
+		REQUIRE( !bid::is_canonical(0x6cb89680u) );
+		REQUIRE( bid::is_canonical(0x6cb8967fu) );
+		REQUIRE( !bid::is_canonical(0x78000001u) );
+		REQUIRE( !bid::is_canonical(0x7c0f4240u) );
+		REQUIRE( bid::is_canonical(0x7c0f423fu) );
+	}
+
+	SECTION("Members") {
+		auto one = d(1);
+		REQUIRE( one.is_finite() );
+		REQUIRE( one.is_normal() );
+		REQUIRE( one.is_canonical() );
+		REQUIRE( one.classify() == IDecimal::Class::PositiveNormal );
+		REQUIRE( (-one).is_signed() );
+		REQUIRE( (-one).classify() == IDecimal::Class::NegativeNormal );
+		REQUIRE( d("1E-6176").is_subnormal() );
+		REQUIRE( longDecimal::Inf.is_inf() );
+		REQUIRE( !longDecimal::Inf.is_finite() );
+		REQUIRE( longDecimal::NaN.is_nan() );
+		REQUIRE( !longDecimal::NaN.is_signaling() );
+		REQUIRE( numeric_limits<LongDecimal>::signaling_NaN().is_signaling() );
+		REQUIRE( shortDecimal::Zero.classify() == IDecimal::Class::PositiveZero );
+		REQUIRE( decimal32::Min.classify() == IDecimal::Class::NegativeNormal );
+
+		static_assert(longDecimal::Max.is_normal() && !longDecimal::Max.is_zero());
+		static_assert(shortDecimal::Inf.classify() == IDecimal::Class::PositiveInfinity);
+	}
+}
+
+TEST_CASE( "Decompose and compose", "[decompose]" ) {
+	std::mt19937_64 gen(rd());
+	auto sign_dist = std::bernoulli_distribution(0.5);
+	auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+	auto narrow_exponent_dist = uniform_int_distribution<int>(-450, 420);
+	auto coefficient = [&]() { return random_coefficient(gen, 34); };
+
+	SECTION("Parts") {
+		REQUIRE( d("-123.45").decompose() == Decomposed{true, 12345, -2} );
+		REQUIRE( d("1.000").decompose() == Decomposed{false, 1000, -3} );
+		REQUIRE( longDecimal::Max.decompose() == Decomposed{false, pow10_128[34] - 1, 6111} );
+		REQUIRE( ShortDecimal("9999999999999999E-5").decompose() == Decomposed{false, 9999999999999999ull, -5} );
+		REQUIRE( Decimal32("-8.388608").decompose() == Decomposed{true, 8388608, -6} );
+		REQUIRE( LongDecimal::from_bits(bid128(false, 3, bid_traits<D128>::coefficient_limit)).decompose() == Decomposed{false, 0, 3} );
+		static_assert((12.5_d64).decompose() == Decomposed{false, 125, -1});
+	}
+
+	SECTION("Non-finite") {
+		ErrorFlags flags = IDecimal::Error::None;
+		REQUIRE( longDecimal::Inf.decompose(&flags) == Decomposed{false, 0, 0} );
+		REQUIRE( flags == IDecimal::Error::Invalid );
+
+		flags = IDecimal::Error::None;
+		REQUIRE( (-std::numeric_limits<ShortDecimal>::infinity()).decompose(&flags) == Decomposed{true, 0, 0} );
+		REQUIRE( std::numeric_limits<Decimal32>::quiet_NaN().decompose(&flags) == Decomposed{false, 0, 0} );
+		REQUIRE( std::numeric_limits<LongDecimal>::signaling_NaN().decompose(&flags) == Decomposed{false, 0, 0} );
+		REQUIRE( flags == IDecimal::Error::Invalid );
+
+		flags = IDecimal::Error::None;
+		REQUIRE( d("-1.5").decompose(&flags) == Decomposed{true, 15, -1} );
+		REQUIRE( flags == IDecimal::Error::None );
+
+		REQUIRE_THROWS_AS( longDecimal::Inf.decompose(), IDecimal::InvalidException );
+		REQUIRE_THROWS_AS( std::numeric_limits<ShortDecimal>::quiet_NaN().decompose(), IDecimal::InvalidException );
+		REQUIRE( longDecimal::Inf.sci() == "+Inf" );
+	}
+
+	SECTION("Round trips") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			auto x = LongDecimal::from_bits(bid128(sign_dist(gen), exponent_dist(gen), coefficient()));
+			ErrorFlags flags = IDecimal::Error::None;
+			REQUIRE( LongDecimal::compose(x.decompose(), IDecimal::Round::NearestEven, &flags).bits() == x.bits() );
+			REQUIRE( flags == IDecimal::Error::None );
+			REQUIRE( LongDecimal::compose(x.decompose()).bits() == x.bits() );
+		}
+	}
+
+	SECTION("Rounding") {
+		// composing up to 34 digits into a narrower type must round as libbid's narrowing does
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			const Decomposed parts = { sign_dist(gen), coefficient(), narrow_exponent_dist(gen) };
+			const Decomposed small = { parts.negative, parts.coefficient, parts.exponent / 4 };
+			const auto wide = bid128(parts.negative, parts.exponent, parts.coefficient);
+			const auto small_wide = bid128(small.negative, small.exponent, small.coefficient);
+			for (auto m : round_modes) {
+				ErrorFlags flags = IDecimal::Error::None, expected_flags = IDecimal::Error::None;
+				REQUIRE( ShortDecimal::compose(parts, m, &flags).bits() == bid128_to_bid64(wide, m, &expected_flags) );
+				REQUIRE( Decimal32::compose(small, m, &flags).bits() == bid128_to_bid32(small_wide, m, &expected_flags) );
+				REQUIRE( flags == expected_flags );
+			}
+		}
+
+		REQUIRE( LongDecimal::compose({false, pow10_128[38] + 5, 0}) == d("1E+38") );
+		REQUIRE_THROWS_AS( ShortDecimal::compose({false, 1, 400}), IDecimal::OverflowException );
+	}
+
+	SECTION("Scientific notation") {
+		REQUIRE( d("-123.4500").sci() == "-1.234500E+2" );
+		REQUIRE( d("12300E+1").sci() == "1.2300E+5" );
+		REQUIRE( d("5E-3").sci() == "5E-3" );
+		REQUIRE( ShortDecimal("-0.00").sci() == "0E+0" );
+		REQUIRE( Decimal32("-Inf").sci() == "-Inf" );
+	}
+}
+
+TEST_CASE( "Hashing", "[hash]" ) {
+	std::mt19937_64 gen(rd());
+	auto sign_dist = std::bernoulli_distribution(0.5);
+	auto exponent_dist = uniform_int_distribution<int>(-6000, 6000);
+	auto coefficient = [&]() { return random_coefficient(gen, 34); };
+
+	SECTION("Cohorts") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			const bool negative = sign_dist(gen);
+			const int exponent = exponent_dist(gen);
+			const auto c = coefficient() | 1;
+			auto x = LongDecimal::from_bits(bid128(negative, exponent, c));
+
+			// every member of the cohort
+			auto scaled = c;
+			for (int k = 1; scaled * 10 < bid_traits<D128>::coefficient_limit; ++k) {
+				scaled *= 10;
+				auto y = LongDecimal::from_bits(bid128(negative, exponent - k, scaled));
+				REQUIRE( x == y );
+				REQUIRE( x.hash() == y.hash() );
+			}
+		}
+	}
+
+	SECTION("Special values") {
+		REQUIRE( d("0").hash() == d("-0.000").hash() );
+		REQUIRE( d("0E+100").hash() == longDecimal::Zero.hash() );
+		REQUIRE( longDecimal::Inf.hash() != (-longDecimal::Inf).hash() );
+		REQUIRE( longDecimal::NaN.hash() == d("-NaN").hash() );
+		REQUIRE( LongDecimal::from_bits(bid128(false, 7, bid_traits<D128>::coefficient_limit)).hash() == d(0).hash() );
+	}
+
+	SECTION("Widths") {
+		REQUIRE( d("1.50").hash() == ShortDecimal("1.5").hash() );
+		REQUIRE( ShortDecimal("-42").hash() == Decimal32("-42.000").hash() );
+		REQUIRE( std::hash<ShortDecimal>()(9999999999999999E-5_d64) == d("99999999999.99999").hash() );
+		static_assert((1.0_d64).hash() == (1_d32).hash());
+	}
+
+	SECTION("Spread") {
+		std::unordered_set<size_t> hashes;
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			hashes.insert(std::hash<LongDecimal>()(LongDecimal::from_bits(bid128(false, -2, i))));
+		}
+		REQUIRE( hashes.size() == LOOP_SIZE * 10 );
+	}
+
+	SECTION("Unordered containers") {
+		std::unordered_map<LongDecimal, int> levels;
+		levels[d("101.25")] += 1;
+		levels[d("101.250")] += 2;
+		levels[d("101.3")] += 4;
+		REQUIRE( levels.size() == 2 );
+		REQUIRE( levels[d("101.2500")] == 3 );
+	}
+}
+
+TEST_CASE( "Order keys", "[keys]" ) {
+	std::mt19937_64 gen(rd());
+	auto word_dist = uniform_int_distribution<uint64_t>();
+	auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+	auto digits_dist = uniform_int_distribution<int>(0, 34);
+
+	// random bits, with the canonical ones kept; 
+	// the structured values crowd the cohorts, zeros, infinities and NaNs
+	auto random128 = [&]() {
+		switch (word_dist(gen) % 4) {
+			case 0: {
+				D128 x = {{word_dist(gen), word_dist(gen)}};
+				return bid_traits<D128>::is_canonical(x)? x : bid128(x.w[1] >> 63, 0, x.w[0]);
+			}
+			case 1: {
+				const D128 specials[] = { longDecimal::Inf.bits(), longDecimal::NaN.bits(), 
+					std::numeric_limits<LongDecimal>::signaling_NaN().bits(), D128{{42, 0x7c00000000000000ull}} };
+				D128 x = specials[word_dist(gen) % 4];
+				x.w[1] |= word_dist(gen) & bid_traits<D128>::sign_mask;
+				return x;
+			}
+			default: {
+				unsigned __int128 c = word_dist(gen) % 1000;
+				for (int i = digits_dist(gen); i > 3 && c < bid_traits<D128>::coefficient_limit / 10; --i) {
+					c *= 10;
+				}
+				return bid128(word_dist(gen) & 1, exponent_dist(gen) % 40, c);
+			}
+		}
+	};
+
+	SECTION("Total order") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			const LongDecimal x = LongDecimal::from_bits(random128());
+			const LongDecimal y = LongDecimal::from_bits(random128());
+			const auto kx = x.key(), ky = y.key();
+			const int c = memcmp(kx.data(), ky.data(), kx.size());
+			REQUIRE( (c <= 0) == static_cast<bool>(__bid128_totalOrder(x.bits(), y.bits())) );
+			REQUIRE( (c >= 0) == static_cast<bool>(__bid128_totalOrder(y.bits(), x.bits())) );
+
+			const ShortDecimal sx = ShortDecimal::from_bits(word_dist(gen));
+			const ShortDecimal sy = ShortDecimal::from_bits((i % 2)? sx.bits() + word_dist(gen) % 3 : word_dist(gen));
+			if (sx.is_canonical() && sy.is_canonical()) {
+				const auto skx = sx.key(), sky = sy.key();
+				const int sc = memcmp(skx.data(), sky.data(), skx.size());
+				REQUIRE( (sc <= 0) == static_cast<bool>(__bid64_totalOrder(sx.bits(), sy.bits())) );
+				REQUIRE( (sc >= 0) == static_cast<bool>(__bid64_totalOrder(sy.bits(), sx.bits())) );
+			}
+		}
+	}
+
+	SECTION("Round trips") {
+		for (int i = 0; i < LOOP_SIZE * 10; ++i) {
+			const D128 x = random128();
+			const D128 decoded = LongDecimal::from_key(LongDecimal::from_bits(x).key()).bits();
+			REQUIRE( memcmp(&x, &decoded, sizeof(x)) == 0 );
+
+			const D64 y = word_dist(gen);
+			if (bid_traits<D64>::is_canonical(y)) {
+				REQUIRE( ShortDecimal::from_key(ShortDecimal::from_bits(y).key()).bits() == y );
+			}
+
+			const D32 z = static_cast<D32>(word_dist(gen));
+			if (bid_traits<D32>::is_canonical(z)) {
+				REQUIRE( Decimal32::from_key(Decimal32::from_bits(z).key()).bits() == z );
+			}
+		}
+		// non-canonical encodings come back canonical
+		REQUIRE( LongDecimal::from_key(LongDecimal::from_bits(bid128(false, 7, bid_traits<D128>::coefficient_limit)).key()).bits() == bid128(false, 7, 0) );
+	}
+
+	SECTION("Order") {
+		const std::vector<ShortDecimal> ordered = { -ShortDecimal::from_bits(bid_traits<D64>::encode_nan(false)), 
+			-ShortDecimal::from_bits(bid_traits<D64>::encode_snan(false)), -shortDecimal::Inf, -1E+10_d64, -1_d64, -1.0_d64, 
+			-0.5_d64, -0_d64, -0.00_d64, 0.00_d64, 0_d64, 0E+3_d64, 1E-398_d64, 1.00_d64, 1.0_d64, 1_d64, 2_d64, shortDecimal::Max, 
+			shortDecimal::Inf, ShortDecimal::from_bits(bid_traits<D64>::encode_snan(false)), shortDecimal::NaN };
+		for (size_t i = 1; i < ordered.size(); ++i) {
+			REQUIRE( ordered[i - 1].key() < ordered[i].key() );
+		}
+		static_assert((1.5_d32).key() < (2_d32).key());
+		static_assert(order_key<D128>::size == 17 && order_key<D64>::size == 9 && order_key<D32>::size == 5);
+	}
+
+	SECTION("Batches") {
+		std::vector<D128> values(LOOP_SIZE), decoded(LOOP_SIZE);
+		std::vector<order_key<D128>::bytes> keys(LOOP_SIZE);
+		std::generate(values.begin(), values.end(), random128);
+		order_key<D128>::encode(values, keys);
+		order_key<D128>::decode(keys, decoded);
+		for (int i = 0; i < LOOP_SIZE; ++i) {
+			REQUIRE( keys[i] == order_key<D128>::encode(values[i]) );
+			REQUIRE( memcmp(&values[i], &decoded[i], sizeof(D128)) == 0 );
+		}
+	}
+}
+
+TEST_CASE( "Radix sort", "[sort]" ) {
+	std::mt19937_64 gen(rd());
+	auto word_dist = uniform_int_distribution<uint64_t>();
+	auto exponent_dist = uniform_int_distribution<int>(-20, 20);
+	const size_t n = LOOP_SIZE * 100;
+
+	// prices with a few exponents, many equal values, and some specials
+	auto price = [&]() {
+		switch (word_dist(gen) % 16) {
+			case 0: return longDecimal::NaN.bits();
+			case 1: return (-longDecimal::Inf).bits();
+			case 2: return bid128(word_dist(gen) & 1, exponent_dist(gen), 0);
+			case 3: return D128{{word_dist(gen), word_dist(gen)}};
+			default: return bid128(word_dist(gen) % 4 == 0, -2 - static_cast<int>(word_dist(gen) % 3), word_dist(gen) % 100000);
+		}
+	};
+	auto key_less = [](const auto & x, const auto & y) { 
+		return x.key() < y.key();
+	};
+
+	SECTION("Raw storage") {
+		std::vector<D128> values(n);
+		std::generate(values.begin(), values.end(), price);
+		std::vector<LongDecimal> expected(n);
+		std::transform(values.begin(), values.end(), expected.begin(), [](const D128 x) { return LongDecimal::from_key(LongDecimal::from_bits(x).key()); });
+		std::stable_sort(expected.begin(), expected.end(), key_less);
+
+		decimal754::sort(std::span<D128>(values));
+		for (size_t i = 0; i < n; ++i) {
+			REQUIRE( memcmp(&values[i], &expected[i], sizeof(D128)) == 0 );
+			if (i > 0) {
+				REQUIRE( __bid128_totalOrder(values[i - 1], values[i]) );
+			}
+		}
+	}
+
+	SECTION("Decimals") {
+		std::vector<ShortDecimal> values(n);
+		std::generate(values.begin(), values.end(), [&]() { return ShortDecimal::from_bits(bid64(word_dist(gen) & 1, exponent_dist(gen), word_dist(gen) % 1000)); });
+		decimal754::sort(std::span<ShortDecimal>(values));
+		REQUIRE( std::is_sorted(values.begin(), values.end(), key_less) );
+		REQUIRE( std::is_sorted(values.begin(), values.end(), [](const ShortDecimal & x, const ShortDecimal & y) { return x < y; }) );
+
+		std::vector<Decimal32> ticks = { 0.05_d32, -1_d32, 0.01_d32, 0.010_d32, 10_d32 };
+		decimal754::sort(std::span<Decimal32>(ticks));
+		REQUIRE( ticks == std::vector<Decimal32>{ -1_d32, 0.010_d32, 0.01_d32, 0.05_d32, 10_d32 } );
+		REQUIRE( ticks[1].bits() == (0.010_d32).bits() );
+
+		std::vector<LongDecimal> empty;
+		decimal754::sort(std::span<LongDecimal>(empty));
+		REQUIRE( empty.empty() );
+	}
+
+	SECTION("Shared exponent") {
+		std::vector<LongDecimal> values(n);
+		std::generate(values.begin(), values.end(), [&]() { return LongDecimal::from_bits(bid128(word_dist(gen) & 1, -4, word_dist(gen) % 1000)); });
+		values[0] = LongDecimal::from_bits(bid128(true, -4, bid_traits<D128>::coefficient_limit - 1));
+		values[1] = LongDecimal::from_bits(bid128(false, -4, bid_traits<D128>::coefficient_limit - 1));
+		std::vector<LongDecimal> expected = values;
+		std::stable_sort(expected.begin(), expected.end(), key_less);
+
+		decimal754::sort(std::span<LongDecimal>(values));
+		for (size_t i = 0; i < n; ++i) {
+			REQUIRE( memcmp(&values[i], &expected[i], sizeof(D128)) == 0 );
+		}
+
+		std::vector<D32> ticks = { (0.25_d32).bits(), (-0.00_d32).bits(), (0.00_d32).bits(), (-0.05_d32).bits() };
+		decimal754::sort(std::span<D32>(ticks));
+		REQUIRE( ticks == std::vector<D32>{ (-0.05_d32).bits(), (-0.00_d32).bits(), (0.00_d32).bits(), (0.25_d32).bits() } );
+	}
+
+	SECTION("Permutations") {
+		std::vector<D128> values(n);
+		std::generate(values.begin(), values.end(), [&]() { return bid128(false, -2, word_dist(gen) % 100); });
+		const std::vector<D128> original = values;
+		std::vector<uint32_t> index(n);
+		std::iota(index.begin(), index.end(), 0);
+
+		decimal754::sort(std::span<D128>(values), std::span<uint32_t>(index));
+		for (size_t i = 0; i < n; ++i) {
+			REQUIRE( memcmp(&values[i], &original[index[i]], sizeof(D128)) == 0 );
+			if (i > 0 && memcmp(&values[i - 1], &values[i], sizeof(D128)) == 0) {
+				REQUIRE( index[i - 1] < index[i] );
+			}
+		}
+	}
+}
+
+TEST_CASE( "Batch arithmetic", "[batch]" ) {
+	std::mt19937_64 gen(rd());
+	auto word_dist = uniform_int_distribution<uint64_t>();
+	auto exponent_dist = uniform_int_distribution<int>(-30, 30);
+	auto mode_dist = uniform_int_distribution<RoundMode>(0, 4);
+	const size_t n = LOOP_SIZE * 10;
+
+	// money with a few exponents, wide values, zeros and specials
+	auto value = [&]() {
+		switch (word_dist(gen) % 12) {
+			case 0: return longDecimal::NaN.bits();
+			case 1: return longDecimal::Inf.bits();
+			case 2: return bid128(word_dist(gen) & 1, exponent_dist(gen), 0);
+			case 3: return bid128(word_dist(gen) & 1, exponent_dist(gen) * 200, (static_cast<unsigned __int128>(word_dist(gen)) << 48) | word_dist(gen));
+			default: return bid128(word_dist(gen) & 1, -2 - static_cast<int>(word_dist(gen) % 3), word_dist(gen) % 10000000);
+		}
+	};
+	std::vector<D128> a(n), b(n), c(n), out(n);
+	std::generate(a.begin(), a.end(), value);
+	std::generate(b.begin(), b.end(), value);
+	std::generate(c.begin(), c.end(), value);
+	const RoundMode round_mode = mode_dist(gen);
+
+	SECTION("Oracle") {
+		typedef D128 (*libbid_op)(D128, D128, RoundMode, ErrorFlags *);
+		typedef void (*kernel)(std::span<const D128>, std::span<const D128>, std::span<D128>, RoundMode, ErrorFlags &);
+		const std::pair<kernel, libbid_op> ops[] = { 
+			{ decimal754::add<D128>, __bid128_add }, { decimal754::sub<D128>, __bid128_sub }, 
+			{ decimal754::mul<D128>, __bid128_mul }, { decimal754::div<D128>, __bid128_div } };
+		for (const auto & op : ops) {
+			ErrorFlags flags = IDecimal::Error::None;
+			op.first(a, b, out, round_mode, flags);
+
+			ErrorFlags expected_flags = IDecimal::Error::None;
+			for (size_t i = 0; i < n; ++i) {
+				const D128 expected = op.second(a[i], b[i], round_mode, &expected_flags);
+				REQUIRE( memcmp(&out[i], &expected, sizeof(D128)) == 0 );
+			}
+			REQUIRE( flags == expected_flags );
+		}
+
+		ErrorFlags flags = IDecimal::Error::None;
+		decimal754::fma<D128>(a, b, c, out, round_mode, flags);
+		ErrorFlags expected_flags = IDecimal::Error::None;
+		for (size_t i = 0; i < n; ++i) {
+			const D128 expected = __bid128_fma(a[i], b[i], c[i], round_mode, &expected_flags);
+			REQUIRE( memcmp(&out[i], &expected, sizeof(D128)) == 0 );
+		}
+		REQUIRE( flags == expected_flags );
+	}
+
+	SECTION("In place") {
+		std::vector<D128> sum = a;
+		ErrorFlags flags = IDecimal::Error::None;
+		decimal754::add(std::span<const D128>(sum), std::span<const D128>(b), std::span<D128>(sum), round_mode, flags);
+		for (size_t i = 0; i < n; ++i) {
+			ErrorFlags ignored = 0;
+			const D128 expected = __bid128_add(a[i], b[i], round_mode, &ignored);
+			REQUIRE( memcmp(&sum[i], &expected, sizeof(D128)) == 0 );
+		}
+	}
+
+	SECTION("Flags") {
+		// flags are added to what is there, and the context is left alone
+		IDecimal::LocalContext local;
+		local->clear();
+		const std::vector<D64> prices = { (1_d64).bits(), (2_d64).bits(), (1E+384_d64).bits() };
+		const std::vector<D64> quantities = { (3_d64).bits(), (0_d64).bits(), (1E+384_d64).bits() };
+		std::vector<D64> result(3);
+
+		ErrorFlags flags = IDecimal::Error::Inexact;
+		decimal754::div<D64>(prices, quantities, result, IDecimal::Round::NearestEven, flags);
+		REQUIRE( flags == (IDecimal::Error::Inexact | IDecimal::Error::DivideByZero) );
+		REQUIRE( ShortDecimal::from_bits(result[1]) == shortDecimal::Inf );
+		REQUIRE( ShortDecimal::from_bits(result[2]) == 1_d64 );
+
+		flags = IDecimal::Error::None;
+		decimal754::mul<D64>(prices, quantities, result, IDecimal::Round::NearestEven, flags);
+		REQUIRE( flags == (IDecimal::Error::Overflow | IDecimal::Error::Inexact) );
+		REQUIRE( local->errors == IDecimal::Error::None );
+	}
+
+	SECTION("Widths") {
+		const std::vector<D32> ticks = { (0.01_d32).bits(), (0.05_d32).bits() };
+		const std::vector<D32> counts = { (3_d32).bits(), (7_d32).bits() };
+		const std::vector<D32> base = { (1_d32).bits(), (-1_d32).bits() };
+		std::vector<D32> result(2);
+		ErrorFlags flags = IDecimal::Error::None;
+		decimal754::fma<D32>(ticks, counts, base, result, IDecimal::Round::NearestEven, flags);
+		REQUIRE( Decimal32::from_bits(result[0]) == 1.03_d32 );
+		REQUIRE( Decimal32::from_bits(result[1]) == -0.65_d32 );
+		REQUIRE( flags == IDecimal::Error::None );
+
+		REQUIRE( fma(1.5_d64, 2_d64, -3_d64, IDecimal::Round::NearestEven, &flags) == 0_d64 );
+		REQUIRE( fma(d("0.1"), d(3), d(1), IDecimal::Round::NearestEven, &flags) == d("1.3") );
+
+		std::vector<D64> empty;
+		decimal754::sub<D64>(empty, empty, empty, IDecimal::Round::NearestEven, flags);
+		REQUIRE( flags == IDecimal::Error::None );
+	}
+}
+
+TEST_CASE( "Vectorized BID64 kernels", "[batch][simd]" ) {
+	std::mt19937_64 gen(rd());
+	auto word_dist = uniform_int_distribution<uint64_t>();
+	const size_t n = LOOP_SIZE * 10 + 7;
+
+	// mostly prices sharing an exponent, with zeros, sums that carry out of the small form,
+	// other exponents, the large form, specials and random bits
+	auto price = [&]() {
+		const bool negative = word_dist(gen) % 3 == 0;
+		switch (word_dist(gen) % 16) {
+			case 0: return bid64(negative, -2, 0);
+			case 1: return bid64(negative, -2, (1ull << 53) - 1 - word_dist(gen) % 1000);
+			case 2: return bid64(negative, -3, word_dist(gen) % 1000000);
+			case 3: return bid64(negative, -2, 9999999999999999ull - word_dist(gen) % 1000);
+			case 4: return (word_dist(gen) & 1)? shortDecimal::NaN.bits() : shortDecimal::Inf.bits() | (negative? bid64_engine::sign_mask : 0);
+			case 5: return word_dist(gen);
+			default: return bid64(negative, -2, word_dist(gen) % 1000000);
+		}
+	};
+	std::vector<D64> a(n), b(n);
+	std::generate(a.begin(), a.end(), price);
+	std::generate(b.begin(), b.end(), price);
+
+	for (unsigned int level = bid64_simd::Scalar; level <= bid64_simd::supported(); ++level) {
+		for (RoundMode round_mode = 0; round_mode <= IDecimal::Round::NearestAway; ++round_mode) {
+			for (const bool subtract : { false, true }) {
+				std::vector<D64> out(n);
+				ErrorFlags flags = IDecimal::Error::None;
+				bid64_simd::add(a, b, out, subtract, round_mode, flags, static_cast<bid64_simd::Level>(level));
+
+				ErrorFlags expected_flags = IDecimal::Error::None;
+				for (size_t i = 0; i < n; ++i) {
+					const D64 expected = subtract? bid_traits<D64>::sub(a[i], b[i], round_mode, &expected_flags) 
+						: bid_traits<D64>::add(a[i], b[i], round_mode, &expected_flags);
+					REQUIRE( out[i] == expected );
+				}
+				REQUIRE( flags == expected_flags );
+
+				// in place
+				std::vector<D64> sum = a;
+				bid64_simd::add(sum, b, sum, subtract, round_mode, flags, static_cast<bid64_simd::Level>(level));
+				REQUIRE( sum == out );
+			}
+		}
+
+		std::vector<int8_t> order(n);
+		ErrorFlags flags = IDecimal::Error::None;
+		bid64_simd::compare(a, b, order, flags, static_cast<bid64_simd::Level>(level));
+		ErrorFlags expected_flags = IDecimal::Error::None;
+		for (size_t i = 0; i < n; ++i) {
+			REQUIRE( order[i] == bid_traits<D64>::compare(a[i], b[i], &expected_flags) );
+		}
+		REQUIRE( flags == expected_flags );
+	}
+
+	SECTION("Batch API") {
+		const std::vector<D64> bids = { (101.25_d64).bits(), (101.50_d64).bits(), (-0.25_d64).bits(), (99.99_d64).bits(), (100.00_d64).bits() };
+		const std::vector<D64> asks = { (101.50_d64).bits(), (101.50_d64).bits(), (0.25_d64).bits(), (100.01_d64).bits(), (1E+2_d64).bits() };
+		std::vector<D64> spread(5);
+		std::vector<int8_t> order(5);
+		ErrorFlags flags = IDecimal::Error::None;
+		decimal754::sub<D64>(asks, bids, spread, IDecimal::Round::NearestEven, flags);
+		decimal754::compare<D64>(bids, asks, order, flags);
+		REQUIRE( ShortDecimal::from_bits(spread[0]) == 0.25_d64 );
+		REQUIRE( spread[1] == (0.00_d64).bits() );
+		REQUIRE( spread[2] == (0.50_d64).bits() );
+		REQUIRE( order == std::vector<int8_t>{ -1, 0, -1, -1, 0 } );
+		REQUIRE( flags == IDecimal::Error::None );
+
+		std::vector<int8_t> nan_order(1);
+		const std::vector<D128> nan = { longDecimal::NaN.bits() };
+		decimal754::compare<D128>(nan, nan, nan_order, flags);
+		REQUIRE( nan_order[0] == 2 );
+	}
+}
+
+TEST_CASE( "Decimal columns", "[column]" ) {
+	SECTION("Values") {
+		DecimalColumn<LongDecimal> prices = { d("101.25"), d("101.50"), d("-0.75") };
+		REQUIRE( prices.size() == 3 );
+		REQUIRE( prices[1] == d("101.5") );
+		REQUIRE( std::accumulate(prices.begin(), prices.end(), d(0)) == d("202.00") );
+		REQUIRE( *std::max_element(prices.begin(), prices.end()) == d("101.50") );
+		REQUIRE( prices.end() - prices.begin() == 3 );
+		REQUIRE( prices.begin()[2] == d("-0.75") );
+		static_assert(std::random_access_iterator<DecimalColumn<LongDecimal>::const_iterator>);
+
+		prices.set(0, d(7));
+		prices.push_back(longDecimal::Inf);
+		REQUIRE( std::vector<LongDecimal>(prices.begin(), prices.end()) == std::vector<LongDecimal>{ d(7), d("101.5"), d("-0.75"), longDecimal::Inf } );
+
+		prices.resize(5);
+		REQUIRE( prices[4].is_zero() );
+		prices.clear();
+		REQUIRE( prices.empty() );
+	}
+
+	SECTION("Storage") {
+		DecimalColumn<ShortDecimal> column;
+		for (int i = 0; i < LOOP_SIZE; ++i) {
+			column.push_back(ShortDecimal(i));
+		}
+		REQUIRE( reinterpret_cast<uintptr_t>(column.bits().data()) % 64 == 0 );
+		REQUIRE( column.bits().size() == LOOP_SIZE );
+		REQUIRE( column.bits()[5] == ShortDecimal(5).bits() );
+		static_assert(sizeof(DecimalColumn<Decimal32>::storage) == 4);
+	}
+
+	SECTION("Shared exponent") {
+		int exponent = 0;
+		DecimalColumn<ShortDecimal> column;
+		REQUIRE( !column.shared_exponent(exponent) );
+
+		column.push_back(1.25_d64);
+		column.push_back(-0.50_d64);
+		column.push_back(0.00_d64);
+		REQUIRE( column.shared_exponent(exponent) );
+		REQUIRE( exponent == -2 );
+
+		column.push_back(1.5_d64);
+		REQUIRE( !column.shared_exponent(exponent) );
+		column.set(3, 1.50_d64);
+		REQUIRE( column.shared_exponent(exponent) );
+
+		column.bits()[1] = shortDecimal::NaN.bits();
+		REQUIRE( !column.shared_exponent(exponent) );
+		column.set(1, 0.10_d64);
+		REQUIRE( column.shared_exponent(exponent) );
+
+		column.resize(5);
+		REQUIRE( !column.shared_exponent(exponent) );
+		column.resize(4);
+		REQUIRE( column.shared_exponent(exponent) );
+		REQUIRE( exponent == -2 );
+	}
+
+	SECTION("Batch kernels") {
+		DecimalColumn<ShortDecimal> bids = { 101.25_d64, 99.50_d64, 100.00_d64 };
+		DecimalColumn<ShortDecimal> asks = { 101.50_d64, 99.75_d64, 100.05_d64 };
+		DecimalColumn<ShortDecimal> spreads(bids.size());
+		ErrorFlags flags = IDecimal::Error::None;
+		decimal754::sub<D64>(asks.bits(), bids.bits(), spreads.bits(), IDecimal::Round::NearestEven, flags);
+
+		int exponent = 0;
+		REQUIRE( spreads.shared_exponent(exponent) );
+		REQUIRE( exponent == -2 );
+		REQUIRE( std::vector<ShortDecimal>(spreads.begin(), spreads.end()) == std::vector<ShortDecimal>{ 0.25_d64, 0.25_d64, 0.05_d64 } );
+		REQUIRE( flags == IDecimal::Error::None );
+	}
+}
+
+TEST_CASE( "Exact summation", "[accumulator]" ) {
+	std::mt19937_64 gen(rd());
+	auto word_dist = uniform_int_distribution<uint64_t>();
+	auto mode_dist = uniform_int_distribution<RoundMode>(0, 4);
+
+	SECTION("One rounding") {
+		// the exact sum of these fits in 34 digits, so a BID128 running sum is exact
+		// and rounding it to BID64 once is the right answer
+		for (int k = 0; k < LOOP_SIZE; ++k) {
+			const RoundMode round_mode = mode_dist(gen);
+			std::vector<D64> values(LOOP_SIZE * 10);
+			std::generate(values.begin(), values.end(), [&]() { 
+				return bid64(word_dist(gen) & 1, static_cast<int>(word_dist(gen) % 11) - 5, word_dist(gen) % 10000000000000000ull); 
+			});
+
+			DecimalAccumulator<ShortDecimal> sum;
+			sum.add(std::span<const D64>(values));
+			ErrorFlags flags = IDecimal::Error::None;
+			const ShortDecimal total = sum.result(round_mode, &flags);
+
+			ErrorFlags ignored = 0;
+			D128 exact = bid128(false, 0, 0);
+			for (const D64 value : values) {
+				exact = __bid128_add(exact, __bid64_to_bid128(value, &ignored), round_mode, &ignored);
+			}
+			REQUIRE( (ignored & IDecimal::Error::Inexact) == 0 );
+			ErrorFlags expected_flags = IDecimal::Error::None;
+			REQUIRE( total.bits() == __bid128_to_bid64(exact, round_mode, &expected_flags) );
+			REQUIRE( flags == expected_flags );
+		}
+	}
+
+	SECTION("Order") {
+		auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+		std::vector<D128> values(LOOP_SIZE * 10);
+		std::generate(values.begin(), values.end(), [&]() { 
+			return bid128(word_dist(gen) & 1, (word_dist(gen) % 4 == 0)? exponent_dist(gen) : -2, 
+				((static_cast<unsigned __int128>(word_dist(gen)) << 64) | word_dist(gen)) % bid_traits<D128>::coefficient_limit); 
+		});
+
+		DecimalAccumulator<LongDecimal> forward;
+		forward.add(std::span<const D128>(values));
+		ErrorFlags flags = IDecimal::Error::None;
+		const LongDecimal expected = forward.result(IDecimal::Round::NearestEven, &flags);
+		for (int k = 0; k < 10; ++k) {
+			std::shuffle(values.begin(), values.end(), gen);
+			DecimalAccumulator<LongDecimal> shuffled;
+			for (const D128 value : values) {
+				shuffled.add(LongDecimal::from_bits(value));
+			}
+			ErrorFlags shuffled_flags = IDecimal::Error::None;
+			const D128 total = shuffled.result(IDecimal::Round::NearestEven, &shuffled_flags).bits();
+			REQUIRE( memcmp(&total, &expected, sizeof(D128)) == 0 );
+			REQUIRE( shuffled_flags == flags );
+		}
+	}
+
+	SECTION("Pairs") {
+		// the sum of two values rounds once in libbid too
+		auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+		auto digits_dist = uniform_int_distribution<int>(0, 34);
+		auto value = [&]() {
+			const int digits = digits_dist(gen);
+			const unsigned __int128 c = ((static_cast<unsigned __int128>(word_dist(gen)) << 64) | word_dist(gen)) % bid_traits<D128>::coefficient_limit;
+			const int exponent = (word_dist(gen) % 2)? exponent_dist(gen) : exponent_dist(gen) % 40;
+			return (digits == 0)? longDecimal::Inf.bits() : bid128(word_dist(gen) & 1, exponent, c % pow10_128[digits]);
+		};
+		for (int i = 0; i < LOOP_SIZE * 100; ++i) {
+			const D128 x = value();
+			const D128 y = (i % 3 == 0)? bid128(!bid_traits<D128>::is_signed(x), std::max(bid_traits<D128>::exponent(x) - static_cast<int>(word_dist(gen) % 40), -6176), word_dist(gen)) : value();
+			const RoundMode round_mode = mode_dist(gen);
+
+			DecimalAccumulator<LongDecimal> sum;
+			sum.add(LongDecimal::from_bits(x));
+			sum.add(LongDecimal::from_bits(y));
+			ErrorFlags flags = IDecimal::Error::None;
+			const D128 total = sum.result(round_mode, &flags).bits();
+			ErrorFlags expected_flags = IDecimal::Error::None;
+			const D128 expected = __bid128_add(x, y, round_mode, &expected_flags);
+			if (bid_traits<D128>::is_nan(expected)) {
+				REQUIRE( bid_traits<D128>::is_nan(total) );
+			} else {
+				REQUIRE( memcmp(&total, &expected, sizeof(D128)) == 0 );
+			}
+			REQUIRE( flags == expected_flags );
+		}
+	}
+
+	SECTION("Exact values") {
+		auto sum = [](std::initializer_list<LongDecimal> values, const RoundMode round_mode = IDecimal::Round::NearestEven) {
+			DecimalAccumulator<LongDecimal> accumulator;
+			accumulator.add(std::span<const LongDecimal>(values.begin(), values.size()));
+			ErrorFlags flags = IDecimal::Error::None;
+			return accumulator.result(round_mode, &flags);
+		};
+		REQUIRE( sum({ d("1E+6000"), d("1E-6000"), d("-1E+6000") }).bits() == d("1E-6000").bits() );
+		REQUIRE( sum({ d("0.1"), d("0.2"), d("-0.3") }).bits() == d("0.0").bits() );
+		REQUIRE( sum({ d("1.10"), d("2.205"), d("1E+1") }).bits() == d("13.305").bits() );
+		REQUIRE( sum({}).bits() == d(0).bits() );
+
+		// zeros
+		REQUIRE( sum({ d("-0"), d("-0.00") }).bits() == d("-0.00").bits() );
+		REQUIRE( sum({ d("-0"), d("0") }).bits() == d("0").bits() );
+		REQUIRE( sum({ d("-0"), d("0") }, IDecimal::Round::Downward).bits() == d("-0").bits() );
+		REQUIRE( sum({ d("0"), d("0E+5") }, IDecimal::Round::Downward).bits() == d("0").bits() );
+		REQUIRE( sum({ d("3"), d("-3") }, IDecimal::Round::Downward).bits() == d("-0").bits() );
+
+		// one rounding at the end
+		DecimalAccumulator<ShortDecimal> cents;
+		for (int i = 0; i < 3; ++i) {
+			cents.add(1E+16_d64);
+			cents.add(0.01_d64);
+		}
+		cents.add(-3E+16_d64);
+		REQUIRE( cents.result().bits() == (0.03_d64).bits() );
+	}
+
+	SECTION("Specials") {
+		ErrorFlags flags = IDecimal::Error::None;
+		DecimalAccumulator<LongDecimal> a;
+		a.add(longDecimal::Max);
+		a.add(longDecimal::Max);
+		REQUIRE( a.result(IDecimal::Round::NearestEven, &flags) == longDecimal::Inf );
+		REQUIRE( flags == (IDecimal::Error::Overflow | IDecimal::Error::Inexact) );
+		REQUIRE( a.result(IDecimal::Round::TowardZero, &flags) == longDecimal::Max );
+
+		a.add(-longDecimal::Inf);
+		REQUIRE( a.result(IDecimal::Round::NearestEven, &flags) == -longDecimal::Inf );
+		a.add(longDecimal::Inf);
+		flags = IDecimal::Error::None;
+		REQUIRE( a.result(IDecimal::Round::NearestEven, &flags).is_nan() );
+		REQUIRE( flags == IDecimal::Error::Invalid );
+
+		DecimalAccumulator<Decimal32> b;
+		b.add(1_d32);
+		b.add(std::numeric_limits<Decimal32>::quiet_NaN());
+		flags = IDecimal::Error::None;
+		REQUIRE( b.result(IDecimal::Round::NearestEven, &flags).is_nan() );
+		REQUIRE( flags == IDecimal::Error::None );
+		REQUIRE_THROWS_AS( (b.add(std::numeric_limits<Decimal32>::signaling_NaN()), b.result()), IDecimal::InvalidException );
+	}
+
+	SECTION("Context") {
+		IDecimal::LocalContext local;
+		local->clear();
+		DecimalAccumulator<ShortDecimal> sum;
+		sum.add(1_d64);
+		sum.add(1E-20_d64);
+		REQUIRE( sum.result() == 1_d64 );
+		REQUIRE( local->errors == IDecimal::Error::Inexact );
+		local->round_mode = IDecimal::Round::Upward;
+		REQUIRE( sum.result() == 1.000000000000001_d64 );
+	}
+}
+
+TEST_CASE( "Parallel summation", "[accumulator][parallel]" ) {
+	std::mt19937_64 gen(rd());
+	auto word_dist = uniform_int_distribution<uint64_t>();
+	auto exponent_dist = uniform_int_distribution<int>(-6176, 6111);
+
+	SECTION("Merging") {
+		std::vector<LongDecimal> values(LOOP_SIZE * 10);
+		std::generate(values.begin(), values.end(), [&]() { 
+			return LongDecimal::from_bits(bid128(word_dist(gen) & 1, (word_dist(gen) % 8 == 0)? exponent_dist(gen) : -2, word_dist(gen))); 
+		});
+		DecimalAccumulator<LongDecimal> whole;
+		whole.add(std::span<const LongDecimal>(values));
+
+		for (int k = 0; k < 10; ++k) {
+			const size_t split = word_dist(gen) % values.size();
+			DecimalAccumulator<LongDecimal> left, right;
+			left.add(std::span<const LongDecimal>(values).subspan(0, split));
+			right.add(std::span<const LongDecimal>(values).subspan(split));
+			right.merge(left);
+
+			ErrorFlags flags = IDecimal::Error::None, expected_flags = IDecimal::Error::None;
+			const D128 merged = right.result(IDecimal::Round::NearestEven, &flags).bits();
+			const D128 expected = whole.result(IDecimal::Round::NearestEven, &expected_flags).bits();
+			REQUIRE( memcmp(&merged, &expected, sizeof(D128)) == 0 );
+			REQUIRE( flags == expected_flags );
+		}
+
+		DecimalAccumulator<ShortDecimal> zeros, negative_zeros;
+		zeros.add(0_d64);
+		negative_zeros.add(-0.0_d64);
+		negative_zeros.merge(zeros);
+		REQUIRE( negative_zeros.result().bits() == (0.0_d64).bits() );
+	}
+
+	SECTION("Threads") {
+		IDecimal::LocalContext local;
+		std::vector<D128> values((1 << 18) + 3);
+		std::generate(values.begin(), values.end(), [&]() { 
+			return bid128(word_dist(gen) & 1, (word_dist(gen) % 1000 == 0)? exponent_dist(gen) % 100 : -2, word_dist(gen) % 100000000);
+		});
+
+		local->clear();
+		DecimalAccumulator<LongDecimal> serial;
+		serial.add(std::span<const D128>(values));
+		const D128 expected = serial.result().bits();
+		const ErrorFlags expected_flags = local->errors;
+
+		for (const unsigned int threads : { 1u, 2u, 3u, 4u, 7u, 0u }) {
+			local->clear();
+			const D128 total = parallel_sum(values, threads).bits();
+			REQUIRE( memcmp(&total, &expected, sizeof(D128)) == 0 );
+			REQUIRE( local->errors == expected_flags );
+		}
+
+		const std::vector<ShortDecimal> prices = { 1.25_d64, 2.50_d64, -0.75_d64 };
+		REQUIRE( parallel_sum(std::span<const ShortDecimal>(prices), 4) == 3_d64 );
+		REQUIRE( parallel_sum(std::vector<D32>{}).bits() == (0_d32).bits() );
 	}
 }